@@ -0,0 +1,28 @@
+# Run at build time (cmake -P) to write OUTPUT, a header defining HELLOWORLD_CODE_VERSION as a
+# digest of every source under SOURCE_DIR. Uncommitted edits and pulls change it without a
+# reconfigure; the header is only rewritten when the digest changes, so unchanged trees do not
+# trigger a rebuild.
+file(GLOB_RECURSE sources
+    ${SOURCE_DIR}/main.cpp
+    ${SOURCE_DIR}/CMakeLists.txt
+    ${SOURCE_DIR}/src/*.cpp
+    ${SOURCE_DIR}/src/*.h
+    ${SOURCE_DIR}/src/*.hpp)
+list(SORT sources)
+
+set(digests "")
+foreach (src ${sources})
+    file(SHA256 ${src} digest)
+    file(RELATIVE_PATH rel ${SOURCE_DIR} ${src})
+    string(APPEND digests "${rel}:${digest}\n")
+endforeach()
+string(SHA256 version "${digests}")
+string(SUBSTRING ${version} 0 16 version)
+
+set(content "#pragma once\n#define HELLOWORLD_CODE_VERSION \"src-${version}\"\n")
+if (EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} old)
+endif()
+if (NOT old STREQUAL content)
+    file(WRITE ${OUTPUT} "${content}")
+endif()
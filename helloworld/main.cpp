@@ -1,12 +1,38 @@
 #include "examples/registry.h"
 #include "logger.h"
+#include "result_cache.h"
+#include "scheduler.h"
 
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <vector>
 
-static int run_example(const examples::Item& ex, const std::vector<std::string>& args)
+// Default plugin directory: `plugins/` next to the runner binary
+static std::string default_plugin_dir(const char* argv0)
 {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path exe = fs::read_symlink("/proc/self/exe", ec);
+    if (ec)
+        exe = fs::absolute(argv0, ec);
+    return (exe.parent_path() / "plugins").string();
+}
+
+static int run_example(const examples::Item& ex, const std::vector<std::string>& args,
+                       logger::Logger& log)
+{
+    std::string err;
+    auto* fn = examples::resolve(ex, &err);
+    if (!fn)
+    {
+        log.error("failed to load example '{}': {}", ex.name, err);
+        return 1;
+    }
+
     // Build argv with argv[0] = example name
     std::vector<std::string> storage;
     storage.reserve(args.size() + 1);
@@ -17,16 +43,43 @@ static int run_example(const examples::Item& ex, const std::vector<std::string>&
     argv.reserve(storage.size());
     for (auto& s : storage)
         argv.push_back(s.data());
-    return ex.fn(static_cast<int>(argv.size()), argv.data());
+    const auto before = result_cache::stats();
+    const auto runs_before = sched::worker_runs();
+    const int rc = fn(static_cast<int>(argv.size()), argv.data());
+
+    // OUTER only takes effect through sched::run_workers; say so rather than ignore it silently
+    if (const int outer = sched::config().outer; outer > 1 && sched::worker_runs() == runs_before)
+        log.warn("example '{}' did not start worker threads; --threads outer={} was not used",
+                 ex.name, outer);
+    if (!result_cache::enabled())
+        return rc;
+
+    const auto after = result_cache::stats();
+    const auto hits = after.hits - before.hits;
+    const auto lookups = hits + after.misses - before.misses;
+    if (lookups > 0)
+    {
+        const auto total = after.total_hits + after.total_misses;
+        log.info("cache: {}/{} hits this run ({:.1f}%), {}/{} overall ({:.1f}%)", hits, lookups,
+                 100.0 * hits / lookups, after.total_hits, total,
+                 total ? 100.0 * after.total_hits / total : 0.0);
+    }
+    return rc;
 }
 
 int main(int argc, char** argv)
 {
     logger::Logger log{"runner", logger::Level::INFO};
 
-    // Parse global args: --list, --example <name>, --args <...>  (or use -- to pass the rest)
+    // Parse global args: --list, --example <name>, --plugins <dir>, --cache <dir>,
+    // --cache-max-mb <n>, --threads <outer:inner>, --placement <mode>, --topology <NxC>,
+    // --args <...>  (or use -- to pass the rest)
     bool list = false;
     std::string example_name; // empty or "all" means run all
+    std::string plugin_dir = default_plugin_dir(argv[0]);
+    std::string cache_dir; // empty disables result caching
+    uint64_t cache_max_mb = 256;
+    sched::Config sched_cfg;
     std::vector<std::string> example_args;
 
     for (int i = 1; i < argc; ++i)
@@ -40,6 +93,35 @@ int main(int argc, char** argv)
         {
             example_name = argv[++i];
         }
+        else if (a == "--plugins" && i + 1 < argc)
+        {
+            plugin_dir = argv[++i];
+        }
+        else if (a == "--cache" && i + 1 < argc)
+        {
+            cache_dir = argv[++i];
+        }
+        else if (a == "--cache-max-mb" && i + 1 < argc)
+        {
+            cache_max_mb = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (a == "--threads" && i + 1 < argc)
+        {
+            if (!sched::parse_threads(argv[++i], sched_cfg.outer, sched_cfg.inner))
+                log.warn("ignoring --threads '{}' (expected OUTER:INNER, e.g. 4:1)", argv[i]);
+            else
+                sched_cfg.explicit_split = true;
+        }
+        else if (a == "--placement" && i + 1 < argc)
+        {
+            if (!sched::parse_placement(argv[++i], sched_cfg.placement))
+                log.warn("ignoring --placement '{}' (expected none|compact|scatter|numa)", argv[i]);
+        }
+        else if (a == "--topology" && i + 1 < argc)
+        {
+            if (!sched::parse_topology(argv[++i], sched_cfg.topology))
+                log.warn("ignoring --topology '{}' (expected NODESxCPUS, e.g. 2x8)", argv[i]);
+        }
         else if (a == "--args")
         {
             for (++i; i < argc; ++i)
@@ -58,6 +140,20 @@ int main(int argc, char** argv)
         }
     }
 
+    // Plugin examples are only listed here; their code is loaded when (and if) they run
+    if (const auto n = examples::load_manifests(plugin_dir))
+        log.debug("found {} plugin example(s) in {}", n, plugin_dir);
+
+    if (!cache_dir.empty() && !result_cache::enable(cache_dir, cache_max_mb << 20))
+        log.warn("cannot use cache directory '{}'; caching disabled", cache_dir);
+
+    // Before any example runs: plugins pick up the inner split when they are loaded
+    sched::configure(sched_cfg);
+    const auto& sc = sched::config();
+    if (sc.outer > 1 || sc.inner > 0 || sc.placement != sched::Placement::None)
+        log.info("threads: outer={} inner={} placement={} on {}", sc.outer, sc.inner,
+                 sched::to_string(sc.placement), sc.topology.describe());
+
     const auto& all = examples::all();
     if (list)
     {
@@ -80,7 +176,7 @@ int main(int argc, char** argv)
         for (const auto& it : all)
         {
             log.info("running example: {}", it.name);
-            last_rc = run_example(it, example_args);
+            last_rc = run_example(it, example_args, log);
             if (last_rc != 0)
             {
                 log.error("example '{}' failed with {}", it.name, last_rc);
@@ -92,7 +188,7 @@ int main(int argc, char** argv)
     if (const auto* it = examples::find(example_name))
     {
         log.info("running example: {}", it->name);
-        return run_example(*it, example_args);
+        return run_example(*it, example_args, log);
     }
 
     log.error("unknown example: '{}' (use --list)", example_name);
@@ -0,0 +1,344 @@
+#include "contour_io.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <opencv2/imgproc.hpp>
+#include <stdexcept>
+
+namespace contour_io
+{
+
+static constexpr char kMagic[4] = {'H', 'W', 'E', 'C'};
+static constexpr uint8_t kVersion = 1;
+
+// Freeman directions; the index is the stored 3-bit code
+static const cv::Point kFreeman[8] = {{1, 0},  {1, -1}, {0, -1}, {-1, -1},
+                                      {-1, 0}, {-1, 1}, {0, 1},  {1, 1}};
+
+// Tracing prefers 4-neighbours so chains follow the edge instead of cutting corners
+static const cv::Point kTraceOrder[8] = {{1, 0},  {0, 1},  {-1, 0}, {0, -1},
+                                         {1, 1},  {-1, 1}, {-1, -1}, {1, -1}};
+
+static int freeman_code(const cv::Point& d)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        if (kFreeman[i] == d)
+            return i;
+    }
+    return -1;
+}
+
+static bool is_chain(const std::vector<cv::Point>& line)
+{
+    for (size_t i = 1; i < line.size(); ++i)
+    {
+        if (freeman_code(line[i] - line[i - 1]) < 0)
+            return false;
+    }
+    return true;
+}
+
+static void put_varint(std::vector<uint8_t>& out, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static uint64_t zigzag(int64_t v)
+{
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v)
+{
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+namespace
+{
+
+struct Reader
+{
+    const uint8_t* p;
+    const uint8_t* end;
+
+    size_t remaining() const
+    {
+        return static_cast<size_t>(end - p);
+    }
+
+    uint64_t varint()
+    {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (p == end)
+                throw std::runtime_error("contour_io::decode: truncated varint");
+            const uint8_t b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return v;
+        }
+        throw std::runtime_error("contour_io::decode: varint overflow");
+    }
+};
+
+} // namespace
+
+EdgeGeometry trace(const cv::Mat& edges)
+{
+    if (edges.type() != CV_8UC1)
+        throw std::runtime_error("contour_io::trace: expected a CV_8UC1 edge map");
+
+    EdgeGeometry geom;
+    geom.width = edges.cols;
+    geom.height = edges.rows;
+
+    // Pixels are cleared as they are consumed so every edge pixel is emitted once
+    cv::Mat rem = edges.clone();
+    auto take_next = [&rem](const cv::Point& p, cv::Point& q)
+    {
+        for (const auto& d : kTraceOrder)
+        {
+            q = p + d;
+            if (q.x < 0 || q.y < 0 || q.x >= rem.cols || q.y >= rem.rows)
+                continue;
+            uchar& px = rem.at<uchar>(q.y, q.x);
+            if (px)
+            {
+                px = 0;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::vector<cv::Point> fwd;
+    std::vector<cv::Point> back;
+    for (int y = 0; y < rem.rows; ++y)
+    {
+        uchar* row = rem.ptr<uchar>(y);
+        for (int x = 0; x < rem.cols; ++x)
+        {
+            if (!row[x])
+                continue;
+            row[x] = 0;
+
+            // Walk both ways from the seed, then stitch back (reversed) + forward
+            const cv::Point start{x, y};
+            cv::Point p = start;
+            cv::Point q;
+            fwd.assign(1, start);
+            while (take_next(p, q))
+            {
+                fwd.push_back(q);
+                p = q;
+            }
+            back.clear();
+            p = start;
+            while (take_next(p, q))
+            {
+                back.push_back(q);
+                p = q;
+            }
+
+            std::vector<cv::Point> line;
+            line.reserve(back.size() + fwd.size());
+            line.insert(line.end(), back.rbegin(), back.rend());
+            line.insert(line.end(), fwd.begin(), fwd.end());
+            geom.polylines.push_back(std::move(line));
+        }
+    }
+    return geom;
+}
+
+void simplify(EdgeGeometry& geom, double epsilon)
+{
+    if (epsilon <= 0.0)
+        return;
+    std::vector<cv::Point> out;
+    for (auto& line : geom.polylines)
+    {
+        if (line.size() <= 2)
+            continue;
+        cv::approxPolyDP(line, out, epsilon, false);
+        line.swap(out);
+    }
+}
+
+std::vector<uint8_t> encode(const EdgeGeometry& geom)
+{
+    std::vector<uint8_t> out(std::begin(kMagic), std::end(kMagic));
+    out.push_back(kVersion);
+    out.push_back(0); // flags (reserved)
+    put_varint(out, static_cast<uint64_t>(geom.width));
+    put_varint(out, static_cast<uint64_t>(geom.height));
+    put_varint(out, geom.polylines.size());
+
+    for (const auto& line : geom.polylines)
+    {
+        if (line.empty())
+        {
+            put_varint(out, 0);
+            continue;
+        }
+        const bool chain = is_chain(line);
+        put_varint(out, (static_cast<uint64_t>(line.size()) << 1) | (chain ? 1U : 0U));
+        put_varint(out, static_cast<uint64_t>(line[0].x));
+        put_varint(out, static_cast<uint64_t>(line[0].y));
+
+        if (chain)
+        {
+            uint32_t acc = 0;
+            int bits = 0;
+            for (size_t i = 1; i < line.size(); ++i)
+            {
+                acc |= static_cast<uint32_t>(freeman_code(line[i] - line[i - 1])) << bits;
+                bits += 3;
+                if (bits >= 8)
+                {
+                    out.push_back(static_cast<uint8_t>(acc));
+                    acc >>= 8;
+                    bits -= 8;
+                }
+            }
+            if (bits > 0)
+                out.push_back(static_cast<uint8_t>(acc));
+        }
+        else
+        {
+            for (size_t i = 1; i < line.size(); ++i)
+            {
+                put_varint(out, zigzag(line[i].x - line[i - 1].x));
+                put_varint(out, zigzag(line[i].y - line[i - 1].y));
+            }
+        }
+    }
+    return out;
+}
+
+EdgeGeometry decode(const uint8_t* data, size_t size)
+{
+    if (size < 6 || !std::equal(std::begin(kMagic), std::end(kMagic), data))
+        throw std::runtime_error("contour_io::decode: not an HWEC stream");
+    if (data[4] != kVersion)
+        throw std::runtime_error("contour_io::decode: unsupported version " +
+                                 std::to_string(data[4]));
+
+    Reader r{data + 6, data + size};
+    EdgeGeometry geom;
+    geom.width = static_cast<int>(r.varint());
+    geom.height = static_cast<int>(r.varint());
+    const uint64_t count = r.varint();
+    if (count > r.remaining())
+        throw std::runtime_error("contour_io::decode: polyline count exceeds stream size");
+    geom.polylines.resize(count);
+
+    for (auto& line : geom.polylines)
+    {
+        const uint64_t head = r.varint();
+        const uint64_t n = head >> 1;
+        if (n == 0)
+            continue;
+        const bool chain = head & 1;
+        // Cheapest encoding is 3 bits per step; reject counts the stream cannot hold
+        if (n - 1 > r.remaining() * 8 / 3 + 1)
+            throw std::runtime_error("contour_io::decode: truncated polyline");
+
+        cv::Point p{static_cast<int>(r.varint()), static_cast<int>(r.varint())};
+        line.reserve(n);
+        line.push_back(p);
+        if (chain)
+        {
+            uint32_t acc = 0;
+            int bits = 0;
+            for (uint64_t i = 1; i < n; ++i)
+            {
+                if (bits < 3)
+                {
+                    if (r.p == r.end)
+                        throw std::runtime_error("contour_io::decode: truncated chain");
+                    acc |= static_cast<uint32_t>(*r.p++) << bits;
+                    bits += 8;
+                }
+                const int code = static_cast<int>(acc & 7U);
+                acc >>= 3;
+                bits -= 3;
+                p = p + kFreeman[code];
+                line.push_back(p);
+            }
+        }
+        else
+        {
+            for (uint64_t i = 1; i < n; ++i)
+            {
+                const auto dx = unzigzag(r.varint());
+                const auto dy = unzigzag(r.varint());
+                p = cv::Point{p.x + static_cast<int>(dx), p.y + static_cast<int>(dy)};
+                line.push_back(p);
+            }
+        }
+    }
+    return geom;
+}
+
+size_t write(const std::string& path, const EdgeGeometry& geom)
+{
+    const auto bytes = encode(geom);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(bytes.data()),
+              static_cast<std::streamsize>(bytes.size()));
+    return out ? bytes.size() : 0;
+}
+
+EdgeGeometry read(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("contour_io::read: failed to open " + path);
+    const std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(in),
+                                     std::istreambuf_iterator<char>()};
+    return decode(bytes.data(), bytes.size());
+}
+
+void draw(cv::Mat& img, const EdgeGeometry& geom, const cv::Scalar& color)
+{
+    const cv::Vec3b bgr(cv::saturate_cast<uchar>(color[0]), cv::saturate_cast<uchar>(color[1]),
+                        cv::saturate_cast<uchar>(color[2]));
+    const uchar gray = cv::saturate_cast<uchar>(color[0]);
+    auto plot = [&](const cv::Point& p)
+    {
+        if (p.x < 0 || p.y < 0 || p.x >= img.cols || p.y >= img.rows)
+            return;
+        if (img.type() == CV_8UC3)
+            img.at<cv::Vec3b>(p.y, p.x) = bgr;
+        else if (img.type() == CV_8UC1)
+            img.at<uchar>(p.y, p.x) = gray;
+        else
+            cv::line(img, p, p, color);
+    };
+
+    for (const auto& line : geom.polylines)
+    {
+        if (line.empty())
+            continue;
+        plot(line[0]);
+        for (size_t i = 1; i < line.size(); ++i)
+        {
+            const cv::Point d = line[i] - line[i - 1];
+            if (std::abs(d.x) <= 1 && std::abs(d.y) <= 1)
+                plot(line[i]);
+            else
+                cv::line(img, line[i - 1], line[i], color, 1, cv::LINE_8);
+        }
+    }
+}
+
+} // namespace contour_io
@@ -0,0 +1,59 @@
+/**
+ * \file
+ * Compact vector storage for edge maps: trace 8-connected edge pixels into polylines and
+ * (de)serialize them in a small binary format.
+ *
+ * File layout (all integers are LEB128 varints unless noted):
+ *
+ *     "HWEC" u8:version u8:flags  width height count  { polyline }*count
+ *     polyline := (points << 1 | chain)  x0 y0  payload
+ *
+ * A chain polyline stores one 3-bit Freeman code per step (8-neighbour moves, packed LSB first);
+ * otherwise each step is a zigzag-encoded (dx, dy) pair. Traced edges are chains; simplified
+ * polylines use deltas.
+ */
+#pragma once
+
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+namespace contour_io
+{
+
+struct EdgeGeometry
+{
+    int width = 0;
+    int height = 0;
+    std::vector<std::vector<cv::Point>> polylines;
+
+    size_t point_count() const
+    {
+        size_t n = 0;
+        for (const auto& p : polylines)
+            n += p.size();
+        return n;
+    }
+};
+
+// Trace every non-zero pixel of an 8-bit edge map into open 8-connected polylines. Each pixel
+// belongs to exactly one polyline; junctions start new ones.
+EdgeGeometry trace(const cv::Mat& edges);
+
+// Douglas-Peucker simplify every polyline in place (epsilon in pixels, <= 0 is a no-op).
+void simplify(EdgeGeometry& geom, double epsilon);
+
+// Serialize to / from the HWEC byte format. decode throws std::runtime_error on bad input.
+std::vector<uint8_t> encode(const EdgeGeometry& geom);
+EdgeGeometry decode(const uint8_t* data, size_t size);
+
+// File helpers. write returns the bytes written (0 on I/O error); read throws like cv_util::load.
+size_t write(const std::string& path, const EdgeGeometry& geom);
+EdgeGeometry read(const std::string& path);
+
+// Paint the geometry onto img (same size as geom) touching only the stored coordinates
+// instead of masking the full frame.
+void draw(cv::Mat& img, const EdgeGeometry& geom, const cv::Scalar& color);
+
+} // namespace contour_io
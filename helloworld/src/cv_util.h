@@ -4,20 +4,29 @@
  */
 #pragma once
 
+#include "frame_ring.h"
+#include "scheduler.h"
+
 #include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace cv_util
 {
 
-// Load an image or throw on failure.
+// Load an image or throw on failure. `shm:<name>` takes the next frame of a shared-memory frame
+// ring instead (see frame_ring.h); that Mat is not a copy and is valid until the next load from
+// the same ring.
 inline cv::Mat load(const std::string& path, int flags = cv::IMREAD_COLOR)
 {
+    if (path.rfind("shm:", 0) == 0)
+        return frame_ring::load(path.substr(4), flags);
     cv::Mat img = cv::imread(path, flags);
     if (img.empty())
     {
@@ -26,6 +35,34 @@ inline cv::Mat load(const std::string& path, int flags = cv::IMREAD_COLOR)
     return img;
 }
 
+// Decode an in-memory encoded image (e.g. a prefetch::Buffer) or throw on failure. The bytes
+// are wrapped in a Mat header, not copied.
+inline cv::Mat decode(std::vector<uchar>& bytes, const std::string& what = "<memory>",
+                      int flags = cv::IMREAD_COLOR)
+{
+    cv::Mat img;
+    if (!bytes.empty())
+        img = cv::imdecode(cv::Mat(1, static_cast<int>(bytes.size()), CV_8U, bytes.data()), flags);
+    if (img.empty())
+    {
+        throw std::runtime_error("cv_util::decode: failed to decode image: " + what);
+    }
+    return img;
+}
+
+// "0", "1", ...: a cv::VideoCapture camera index rather than a file name.
+inline bool isCameraIndex(const std::string& s)
+{
+    return !s.empty() && std::all_of(s.begin(), s.end(),
+                                     [](unsigned char c) { return std::isdigit(c) != 0; });
+}
+
+// True when a GUI (X11/Wayland) is available for cv::imshow.
+inline bool hasGui()
+{
+    return std::getenv("DISPLAY") || std::getenv("WAYLAND_DISPLAY");
+}
+
 // Show image in a resizable window with optional max size. Returns true if shown.
 inline bool quickDisplay(const cv::Mat& img, const std::string& title = "Image", int wait_ms = 0,
                          bool resizable = true, int max_width = 1024, int max_height = 768)
@@ -33,9 +70,7 @@ inline bool quickDisplay(const cv::Mat& img, const std::string& title = "Image",
     if (img.empty())
         return false;
 
-    // Detect GUI availability (X11/Wayland)
-    const bool has_gui = std::getenv("DISPLAY") || std::getenv("WAYLAND_DISPLAY");
-    if (!has_gui)
+    if (!hasGui())
         return false;
 
     int flags = resizable ? cv::WINDOW_NORMAL : cv::WINDOW_AUTOSIZE;
@@ -60,4 +95,10 @@ inline bool quickDisplay(const cv::Mat& img, const std::string& title = "Image",
     return true;
 }
 
+// Apply the runner's inner thread count (`--threads OUTER:INNER`) to OpenCV. Every example
+// includes this header, so the hook is installed in the runner binary or in each plugin as it is
+// loaded. OpenCV: 0 runs its functions sequentially, n > 1 sizes its pool.
+inline const bool kInnerThreadsHook =
+    sched::set_inner_threads_hook([](int inner) { cv::setNumThreads(inner == 1 ? 0 : inner); });
+
 } // namespace cv_util
@@ -0,0 +1,400 @@
+/**
+ * \file
+ * \ingroup examples
+ * UPC-A barcode decoding from scanline run lengths.
+ *
+ * Selected scanlines (rows, and columns for the 90 degree orientation) are averaged over a
+ * small band, thresholded at their min/max midpoint and turned into run lengths with SSE2
+ * transition detection. Each run sequence is decoded forwards and backwards (0/180 degrees);
+ * all scanlines run in parallel and the checksum-valid results are majority voted.
+ */
+#include "cli/argparse.h"
+#include "cv_util.h"
+#include "examples/registry.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <opencv2/imgproc.hpp>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using examples::ExampleFn;
+
+namespace
+{
+
+// Element widths (in modules) of each digit in reading order. Left-half digits start with a
+// space, right-half digits with a bar; the widths are the same for both halves.
+constexpr int kDigitWidths[10][4] = {{3, 2, 1, 1}, {2, 2, 2, 1}, {2, 1, 2, 2}, {1, 4, 1, 1},
+                                     {1, 1, 3, 2}, {1, 2, 3, 1}, {1, 1, 1, 4}, {1, 3, 1, 2},
+                                     {1, 2, 1, 3}, {3, 1, 1, 2}};
+
+constexpr int kUpcRuns = 59;    // 3 (start) + 6*4 + 5 (middle) + 6*4 + 3 (end)
+constexpr int kUpcModules = 95; // 3 + 42 + 5 + 42 + 3
+constexpr int kQuietModules = 9;
+
+struct Scan
+{
+    std::string digits; // empty when nothing decoded
+    int orientation = 0;
+    int line = 0;
+};
+
+// Indices i where line[i] and line[i + 1] fall on different sides of thr
+void find_transitions(const uint8_t* line, int n, uint8_t thr, std::vector<int>& out)
+{
+    out.clear();
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i t = _mm_set1_epi8(static_cast<char>(thr));
+    for (; i + 17 <= n; i += 16)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line + i + 1));
+        // Unsigned x >= thr  <=>  max(x, thr) == x
+        const __m128i la = _mm_cmpeq_epi8(_mm_max_epu8(a, t), a);
+        const __m128i lb = _mm_cmpeq_epi8(_mm_max_epu8(b, t), b);
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_xor_si128(la, lb)));
+        while (mask)
+        {
+            out.push_back(i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + 1 < n; ++i)
+    {
+        if ((line[i] >= thr) != (line[i + 1] >= thr))
+            out.push_back(i);
+    }
+}
+
+int check_digit(const std::string& first11)
+{
+    int sum = 0;
+    for (size_t i = 0; i < 11; ++i)
+        sum += (first11[i] - '0') * (i % 2 == 0 ? 3 : 1);
+    return (10 - sum % 10) % 10;
+}
+
+// Best matching digit for four element widths, or -1 if nothing is close enough
+int match_digit(const int* w)
+{
+    const double sum = w[0] + w[1] + w[2] + w[3];
+    int best = -1;
+    double best_err = 1.5; // total deviation in modules we still accept
+    for (int d = 0; d < 10; ++d)
+    {
+        double err = 0.0;
+        for (int k = 0; k < 4; ++k)
+            err += std::abs(w[k] * 7.0 / sum - kDigitWidths[d][k]);
+        if (err < best_err)
+        {
+            best_err = err;
+            best = d;
+        }
+    }
+    return best;
+}
+
+bool is_guard(const int* w, int n, double unit)
+{
+    for (int k = 0; k < n; ++k)
+    {
+        if (w[k] < 0.4 * unit || w[k] > 1.8 * unit)
+            return false;
+    }
+    return true;
+}
+
+// Decode 12 UPC-A digits from alternating run widths. dark0 tells whether runs[0] is a bar.
+std::string decode_runs(const std::vector<int>& runs, bool dark0)
+{
+    const int n = static_cast<int>(runs.size());
+    for (int s = dark0 ? 0 : 1; s + kUpcRuns <= n; s += 2)
+    {
+        const int* w = runs.data() + s;
+        int total = 0;
+        for (int k = 0; k < kUpcRuns; ++k)
+            total += w[k];
+        const double unit = static_cast<double>(total) / kUpcModules;
+        // The preceding space must look like a quiet zone (or be the image border)
+        if (s > 0 && runs[s - 1] < 5 * unit)
+            continue;
+        if (!is_guard(w, 3, unit) || !is_guard(w + 27, 5, unit) || !is_guard(w + 56, 3, unit))
+            continue;
+
+        std::string digits;
+        for (int d = 0; d < 12; ++d)
+        {
+            const int off = d < 6 ? 3 + 4 * d : 32 + 4 * (d - 6);
+            const int v = match_digit(w + off);
+            if (v < 0)
+                break;
+            digits.push_back(static_cast<char>('0' + v));
+        }
+        if (digits.size() == 12 && check_digit(digits) == digits[11] - '0')
+            return digits;
+    }
+    return {};
+}
+
+// Average `band` rows around y into line and decode the result in both directions
+std::string scan_line(const cv::Mat& gray, int y, int band, std::vector<uint8_t>& line,
+                      std::vector<uint16_t>& acc, std::vector<int>& edges, std::vector<int>& runs)
+{
+    const int y0 = std::max(0, y - band / 2);
+    const int y1 = std::min(gray.rows, y0 + std::max(1, band));
+    const int cols = gray.cols;
+    acc.assign(static_cast<size_t>(cols), 0);
+    for (int r = y0; r < y1; ++r)
+    {
+        const uint8_t* p = gray.ptr<uint8_t>(r);
+        for (int x = 0; x < cols; ++x)
+            acc[x] = static_cast<uint16_t>(acc[x] + p[x]);
+    }
+    line.resize(static_cast<size_t>(cols));
+    const int rows = y1 - y0;
+    uint8_t lo = 255;
+    uint8_t hi = 0;
+    for (int x = 0; x < cols; ++x)
+    {
+        line[x] = static_cast<uint8_t>(acc[x] / rows);
+        lo = std::min(lo, line[x]);
+        hi = std::max(hi, line[x]);
+    }
+    if (hi - lo < 32)
+        return {}; // flat line, no bars
+    const auto thr = static_cast<uint8_t>((lo + hi + 1) / 2);
+
+    find_transitions(line.data(), cols, thr, edges);
+    if (edges.size() < static_cast<size_t>(kUpcRuns) + 1)
+        return {};
+    runs.clear();
+    for (size_t k = 1; k < edges.size(); ++k)
+        runs.push_back(edges[k] - edges[k - 1]);
+    const bool dark0 = line[edges[0] + 1] < thr;
+
+    auto digits = decode_runs(runs, dark0);
+    if (digits.empty())
+    {
+        // Upside-down barcode: same runs, opposite reading direction
+        std::reverse(runs.begin(), runs.end());
+        const bool dark_last = (runs.size() % 2 == 1) ? dark0 : !dark0;
+        digits = decode_runs(runs, dark_last);
+    }
+    return digits;
+}
+
+// Try `lines` rows and `lines` columns in parallel; majority vote over valid decodes
+Scan decode(const cv::Mat& gray, int lines, int band)
+{
+    cv::Mat cols;
+    cv::transpose(gray, cols);
+    const cv::Mat* views[2] = {&gray, &cols};
+
+    std::vector<Scan> scans(static_cast<size_t>(2 * lines));
+    cv::parallel_for_(cv::Range(0, static_cast<int>(scans.size())),
+                      [&](const cv::Range& range)
+                      {
+                          std::vector<uint8_t> line;
+                          std::vector<uint16_t> acc;
+                          std::vector<int> edges;
+                          std::vector<int> runs;
+                          for (int i = range.start; i < range.end; ++i)
+                          {
+                              const int o = i / lines;
+                              const cv::Mat& img = *views[o];
+                              const int y = (i % lines + 1) * img.rows / (lines + 1);
+                              scans[i] = {scan_line(img, y, band, line, acc, edges, runs), o * 90,
+                                          y};
+                          }
+                      });
+
+    std::map<std::string, int> votes;
+    Scan best;
+    int best_votes = 0;
+    for (const auto& s : scans)
+    {
+        if (s.digits.empty())
+            continue;
+        const int v = ++votes[s.digits];
+        if (v > best_votes)
+        {
+            best_votes = v;
+            best = s;
+        }
+    }
+    return best;
+}
+
+// Render a UPC-A symbol (12 digits, check digit included) with quiet zones on white
+cv::Mat render(const std::string& digits, int module, int height)
+{
+    std::string bits = "101";
+    for (int d = 0; d < 12; ++d)
+    {
+        if (d == 6)
+            bits += "01010";
+        const auto& w = kDigitWidths[digits[d] - '0'];
+        char color = d < 6 ? '0' : '1';
+        for (int k = 0; k < 4; ++k)
+        {
+            bits.append(static_cast<size_t>(w[k]), color);
+            color = color == '0' ? '1' : '0';
+        }
+    }
+    bits += "101";
+
+    const int margin = 4 * module;
+    cv::Mat img(height + 2 * margin, (kUpcModules + 2 * kQuietModules) * module, CV_8UC1,
+                cv::Scalar(255));
+    for (int m = 0; m < static_cast<int>(bits.size()); ++m)
+    {
+        if (bits[m] == '1')
+        {
+            cv::rectangle(img, cv::Rect((kQuietModules + m) * module, margin, module, height),
+                          cv::Scalar(0), cv::FILLED);
+        }
+    }
+    return img;
+}
+
+// Random symbol in a random orientation with blur and additive Gaussian noise
+cv::Mat synthesize(cv::RNG& rng, std::string& digits, int module, double noise)
+{
+    digits.clear();
+    for (int i = 0; i < 11; ++i)
+        digits.push_back(static_cast<char>('0' + rng.uniform(0, 10)));
+    digits.push_back(static_cast<char>('0' + check_digit(digits)));
+
+    cv::Mat img = render(digits, module, 40 * module);
+    const int rot = rng.uniform(0, 4);
+    if (rot > 0)
+        cv::rotate(img, img, rot - 1);
+    cv::GaussianBlur(img, img, cv::Size(3, 3), 0);
+
+    cv::Mat noisy;
+    img.convertTo(noisy, CV_16S);
+    cv::Mat n(img.size(), CV_16SC1);
+    cv::randn(n, cv::Scalar(0), cv::Scalar(noise));
+    cv::add(noisy, n, noisy);
+    noisy.convertTo(img, CV_8U);
+    return img;
+}
+
+int run_bench(logger::Logger& log, int iterations, int samples, int module, double noise,
+              int lines, int band)
+{
+    cv::RNG rng(0x5eed);
+    std::vector<cv::Mat> images(static_cast<size_t>(samples));
+    std::vector<std::string> truth(static_cast<size_t>(samples));
+    for (int i = 0; i < samples; ++i)
+        images[i] = synthesize(rng, truth[i], module, noise);
+
+    int ok = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        const int k = i % samples;
+        if (decode(images[k], lines, band).digits == truth[k])
+            ++ok;
+    }
+    const std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+
+    log.info("bench: {} decodes of {} synthetic {}x{} symbols (module={}px, noise={}) in {:.3f} s",
+             iterations, samples, images[0].cols, images[0].rows, module, noise, dt.count());
+    log.info("bench: {:.1f} decodes/sec, {:.1f}% correct", iterations / dt.count(),
+             100.0 * ok / std::max(1, iterations));
+    return 0;
+}
+
+} // namespace
+
+static int barcode_example(int argc, char** argv)
+{
+    logger::Logger log{"barcode", logger::Level::INFO};
+
+    cli::ArgParser ap{"barcode"};
+    ap.add_option("lines", 'n', "Scanlines to try per orientation", "16");
+    ap.add_option("band", 'w', "Rows averaged into each scanline", "5");
+    ap.add_option("bench", 'B', "Benchmark: number of decodes on synthetic symbols (0 = off)",
+                  "0");
+    ap.add_option("samples", 'S', "Benchmark: distinct synthetic symbols", "64");
+    ap.add_option("module", 'm', "Benchmark: module width in pixels", "3");
+    ap.add_option("noise", 'N', "Benchmark: Gaussian noise sigma (gray levels)", "12");
+    ap.add_positional("path", "Image path (default: assets/upc_a.png)");
+    if (!ap.parse(argc, argv) || ap.help())
+    {
+        log.info("\n{}", ap.usage());
+        return ap.help() ? 0 : 2;
+    }
+    const int lines = std::max(1, ap.get_int("lines", 16));
+    const int band = std::clamp(ap.get_int("band", 5), 1, 255); // 16-bit row accumulator
+
+    if (const int iterations = ap.get_int("bench", 0); iterations > 0)
+    {
+        return run_bench(log, iterations, std::max(1, ap.get_int("samples", 64)),
+                         std::max(1, ap.get_int("module", 3)),
+                         std::max(0.0, ap.get_double("noise", 12.0)), lines, band);
+    }
+
+    std::string path =
+        ap.positionals().empty() ? std::string{"assets/upc_a.png"} : ap.positionals().front();
+    log.info("loading {} (lines={}, band={})", path, lines, band);
+
+    cv::Mat gray;
+    try
+    {
+        gray = cv_util::load(path, cv::IMREAD_GRAYSCALE);
+    }
+    catch (const std::exception& e)
+    {
+        log.error("{}", e.what());
+        return 1;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const Scan scan = decode(gray, lines, band);
+    const std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t0;
+    if (scan.digits.empty())
+    {
+        log.error("no UPC-A symbol found ({:.3f} ms)", dt.count());
+        return 1;
+    }
+    log.info("UPC-A {} (orientation={}, line={}) in {:.3f} ms", scan.digits, scan.orientation,
+             scan.line, dt.count());
+
+    // Visualize: mark the winning scanline and print the digits
+    cv::Mat vis;
+    cv::cvtColor(gray, vis, cv::COLOR_GRAY2BGR);
+    if (scan.orientation == 0)
+        cv::line(vis, {0, scan.line}, {vis.cols - 1, scan.line}, cv::Scalar(0, 0, 255), 2);
+    else
+        cv::line(vis, {scan.line, 0}, {scan.line, vis.rows - 1}, cv::Scalar(0, 0, 255), 2);
+    cv::putText(vis, scan.digits, {10, 30}, cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 160, 0),
+                2, cv::LINE_AA);
+
+    if (!cv_util::quickDisplay(vis, "Barcode", 0, true, 1024, 768))
+    {
+        const std::string out = "output_barcode.png";
+        if (!cv::imwrite(out, vis))
+        {
+            log.error("failed to write {}", out);
+            return 1;
+        }
+        log.warn("headless environment; wrote {}", out);
+    }
+
+    return 0;
+}
+
+REGISTER_EXAMPLE("barcode", barcode_example, "UPC-A decoding from SIMD scanline run lengths");
@@ -0,0 +1,515 @@
+/**
+ * \file
+ * \ingroup examples
+ * Near-duplicate image detection with perceptual hashes and a multi-index Hamming search.
+ *
+ * Every input is reduced to a 64- or 256-bit dHash (sign of horizontal gradients on a tiny gray
+ * thumbnail) or pHash (low DCT coefficients against their median). Hashes are indexed by
+ * multi-index hashing: the hash is cut into 16-bit chunks with one table each, and a query only
+ * probes chunk values within threshold / chunks bits of its own before checking candidates with
+ * an SSE2 popcount of the full XOR. Inputs within the threshold are joined into clusters.
+ */
+#include "cli/argparse.h"
+#include "cv_util.h"
+#include "examples/registry.h"
+#include "logger.h"
+#include "scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <numeric>
+#include <opencv2/imgproc.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using examples::ExampleFn;
+
+namespace
+{
+
+enum class Method
+{
+    DHash,
+    PHash
+};
+
+#if defined(__SSE2__)
+// Per-lane popcount of two 64-bit lanes: SWAR bit counts per byte, summed by psadbw
+inline __m128i popcount_epi64(__m128i v)
+{
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0f);
+    v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), m1));
+    v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi64(v, 2), m2));
+    v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), m4);
+    return _mm_sad_epu8(v, _mm_setzero_si128());
+}
+
+inline int sum_lanes(__m128i v)
+{
+    return _mm_cvtsi128_si32(v) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(v, v));
+}
+#endif
+
+// Hamming distance of two hashes of `words` 64-bit words
+inline int hamming(const uint64_t* a, const uint64_t* b, int words)
+{
+    int w = 0;
+    int d = 0;
+#if defined(__SSE2__)
+    for (; w + 2 <= words; w += 2)
+    {
+        const __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + w)),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + w)));
+        d += sum_lanes(popcount_epi64(x));
+    }
+#endif
+    for (; w < words; ++w)
+        d += __builtin_popcountll(a[w] ^ b[w]);
+    return d;
+}
+
+// Flat array of fixed-width hashes
+struct HashSet
+{
+    int words = 1; // 1 (64-bit) or 4 (256-bit)
+    std::vector<uint64_t> data;
+
+    size_t size() const
+    {
+        return data.size() / static_cast<size_t>(words);
+    }
+    const uint64_t* at(size_t i) const
+    {
+        return data.data() + i * static_cast<size_t>(words);
+    }
+};
+
+// Reference search: every entry within r of q, two 64-bit hashes per SSE2 register
+void linear_scan(const HashSet& set, const uint64_t* q, int r, std::vector<uint32_t>& out)
+{
+    out.clear();
+    const size_t n = set.size();
+    size_t i = 0;
+#if defined(__SSE2__)
+    if (set.words == 1)
+    {
+        const __m128i qq = _mm_set1_epi64x(static_cast<long long>(q[0]));
+        for (; i + 2 <= n; i += 2)
+        {
+            const __m128i x =
+                _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.at(i))), qq);
+            const __m128i c = popcount_epi64(x);
+            if (_mm_cvtsi128_si32(c) <= r)
+                out.push_back(static_cast<uint32_t>(i));
+            if (_mm_cvtsi128_si32(_mm_unpackhi_epi64(c, c)) <= r)
+                out.push_back(static_cast<uint32_t>(i + 1));
+        }
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        if (hamming(set.at(i), q, set.words) <= r)
+            out.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+// Multi-index hashing: one table per 16-bit chunk. If two hashes are within r bits, at least
+// one of their m chunks is within r / m bits (pigeonhole), so probing every value within that
+// radius of each query chunk finds all matches; candidates are verified on the full hash.
+class MultiIndex
+{
+  public:
+    explicit MultiIndex(const HashSet& set) : set_(set), chunks_(set.words * 4)
+    {
+        const size_t n = set.size();
+        offsets_.assign(static_cast<size_t>(chunks_), std::vector<uint32_t>(kBuckets + 1, 0));
+        ids_.assign(static_cast<size_t>(chunks_), std::vector<uint32_t>(n));
+        // Counting sort of entry ids by chunk value (CSR layout: contiguous buckets)
+        for (int c = 0; c < chunks_; ++c)
+        {
+            auto& off = offsets_[c];
+            for (size_t i = 0; i < n; ++i)
+                ++off[chunk(set.at(i), c) + 1];
+            std::partial_sum(off.begin(), off.end(), off.begin());
+            std::vector<uint32_t> fill(off.begin(), off.end() - 1);
+            for (size_t i = 0; i < n; ++i)
+                ids_[c][fill[chunk(set.at(i), c)]++] = static_cast<uint32_t>(i);
+        }
+        seen_.assign(n, 0);
+    }
+
+    // Entries within r bits of q (unordered). Not thread-safe: dedups candidates with stamps.
+    void query(const uint64_t* q, int r, std::vector<uint32_t>& out)
+    {
+        out.clear();
+        const auto& masks = masks_for(r / chunks_);
+        if (++stamp_ == 0)
+        {
+            std::fill(seen_.begin(), seen_.end(), 0);
+            stamp_ = 1;
+        }
+        for (int c = 0; c < chunks_; ++c)
+        {
+            const uint16_t key = chunk(q, c);
+            const auto& off = offsets_[c];
+            const auto& ids = ids_[c];
+            for (const uint16_t m : masks)
+            {
+                const uint16_t probe = key ^ m;
+                for (uint32_t k = off[probe]; k < off[probe + 1]; ++k)
+                {
+                    const uint32_t id = ids[k];
+                    if (seen_[id] == stamp_)
+                        continue;
+                    seen_[id] = stamp_;
+                    if (hamming(set_.at(id), q, set_.words) <= r)
+                        out.push_back(id);
+                }
+            }
+        }
+    }
+
+    int chunks() const
+    {
+        return chunks_;
+    }
+
+  private:
+    static constexpr size_t kBuckets = 1 << 16;
+
+    static uint16_t chunk(const uint64_t* h, int c)
+    {
+        return static_cast<uint16_t>(h[c / 4] >> (16 * (c % 4)));
+    }
+
+    // All 16-bit XOR masks with at most `radius` bits set, fewest bits first
+    const std::vector<uint16_t>& masks_for(int radius)
+    {
+        auto& masks = masks_[radius];
+        if (masks.empty())
+        {
+            for (int bits = 0; bits <= std::min(radius, 16); ++bits)
+                for (uint32_t m = 0; m < kBuckets; ++m)
+                    if (__builtin_popcount(m) == bits)
+                        masks.push_back(static_cast<uint16_t>(m));
+        }
+        return masks;
+    }
+
+    const HashSet& set_;
+    int chunks_;
+    std::vector<std::vector<uint32_t>> offsets_;
+    std::vector<std::vector<uint32_t>> ids_;
+    std::map<int, std::vector<uint16_t>> masks_;
+    std::vector<uint32_t> seen_;
+    uint32_t stamp_ = 0;
+};
+
+// dHash: side x side bits from a (side + 1) x side thumbnail, 1 where a pixel is darker than its
+// right neighbour. pHash: side x side lowest DCT frequencies of a 4x larger thumbnail, 1 where a
+// coefficient is above their median (DC excluded from the median).
+void compute_hash(const cv::Mat& img, Method method, int words, uint64_t* out)
+{
+    const int side = words == 1 ? 8 : 16;
+    cv::Mat gray = img;
+    if (img.channels() == 3)
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+    std::fill(out, out + words, 0);
+
+    if (method == Method::DHash)
+    {
+        cv::Mat thumb;
+        cv::resize(gray, thumb, cv::Size(side + 1, side), 0, 0, cv::INTER_AREA);
+        for (int y = 0; y < side; ++y)
+        {
+            const uint8_t* row = thumb.ptr<uint8_t>(y);
+            for (int x = 0; x < side; ++x)
+            {
+                const int bit = y * side + x;
+                if (row[x] < row[x + 1])
+                    out[bit / 64] |= 1ULL << (bit % 64);
+            }
+        }
+        return;
+    }
+
+    cv::Mat thumb;
+    cv::resize(gray, thumb, cv::Size(side * 4, side * 4), 0, 0, cv::INTER_AREA);
+    thumb.convertTo(thumb, CV_32F);
+    cv::Mat freq;
+    cv::dct(thumb, freq);
+    std::vector<float> low;
+    low.reserve(static_cast<size_t>(side * side));
+    for (int y = 0; y < side; ++y)
+        for (int x = 0; x < side; ++x)
+            low.push_back(freq.at<float>(y, x));
+    std::vector<float> ac(low.begin() + 1, low.end());
+    std::nth_element(ac.begin(), ac.begin() + ac.size() / 2, ac.end());
+    const float median = ac[ac.size() / 2];
+    for (size_t bit = 0; bit < low.size(); ++bit)
+        if (low[bit] > median)
+            out[bit / 64] |= 1ULL << (bit % 64);
+}
+
+// Disjoint-set forest over input indices
+struct Clusters
+{
+    std::vector<uint32_t> parent;
+
+    explicit Clusters(size_t n) : parent(n)
+    {
+        std::iota(parent.begin(), parent.end(), 0U);
+    }
+    uint32_t find(uint32_t i)
+    {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    }
+    void join(uint32_t a, uint32_t b)
+    {
+        a = find(a);
+        b = find(b);
+        if (a != b)
+            parent[std::max(a, b)] = std::min(a, b); // lowest index represents the cluster
+    }
+};
+
+// Directories expand to the images directly inside them
+std::vector<std::string> expand_inputs(const std::vector<std::string>& args)
+{
+    namespace fs = std::filesystem;
+    std::vector<std::string> paths;
+    for (const auto& a : args)
+    {
+        std::error_code ec;
+        if (!fs::is_directory(a, ec))
+        {
+            paths.push_back(a);
+            continue;
+        }
+        std::vector<std::string> found;
+        for (const auto& de : fs::directory_iterator(a, ec))
+            if (de.is_regular_file(ec) && cv::haveImageReader(de.path().string()))
+                found.push_back(de.path().string());
+        std::sort(found.begin(), found.end());
+        paths.insert(paths.end(), found.begin(), found.end());
+    }
+    return paths;
+}
+
+int run_dedupe(const std::vector<std::string>& paths, Method method, int words, int threshold,
+               logger::Logger& log)
+{
+    HashSet set;
+    set.words = words;
+    set.data.assign(paths.size() * static_cast<size_t>(words), 0);
+    std::vector<std::string> errors(paths.size());
+
+    // Images are independent: the runner's outer workers (`--threads`) take them one at a time
+    std::atomic<size_t> next{0};
+    const auto t0 = std::chrono::steady_clock::now();
+    sched::run_workers(
+        [&](int)
+        {
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < paths.size();)
+            {
+                try
+                {
+                    compute_hash(cv_util::load(paths[i]), method, words,
+                                 set.data.data() + i * static_cast<size_t>(words));
+                }
+                catch (const std::exception& e)
+                {
+                    errors[i] = e.what();
+                }
+            }
+        });
+    const std::chrono::duration<double> t_hash = std::chrono::steady_clock::now() - t0;
+
+    // Unreadable inputs are reported and left out of the search
+    std::vector<uint32_t> valid;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        if (errors[i].empty())
+            valid.push_back(static_cast<uint32_t>(i));
+        else
+            log.error("{}", errors[i]);
+    }
+    HashSet ok;
+    ok.words = words;
+    for (const uint32_t i : valid)
+        ok.data.insert(ok.data.end(), set.at(i), set.at(i) + words);
+
+    const auto t1 = std::chrono::steady_clock::now();
+    MultiIndex index(ok);
+    Clusters clusters(ok.size());
+    std::vector<uint32_t> hits;
+    for (size_t i = 0; i < ok.size(); ++i)
+    {
+        index.query(ok.at(i), threshold, hits);
+        for (const uint32_t j : hits)
+            clusters.join(static_cast<uint32_t>(i), j);
+    }
+    const std::chrono::duration<double> t_search = std::chrono::steady_clock::now() - t1;
+
+    std::map<uint32_t, std::vector<uint32_t>> groups;
+    for (size_t i = 0; i < ok.size(); ++i)
+        groups[clusters.find(static_cast<uint32_t>(i))].push_back(static_cast<uint32_t>(i));
+    size_t dup_clusters = 0;
+    size_t redundant = 0;
+    for (const auto& [rep, members] : groups)
+    {
+        if (members.size() < 2)
+            continue;
+        ++dup_clusters;
+        redundant += members.size() - 1;
+        log.info("cluster {} ({} images): {}", dup_clusters, members.size(), paths[valid[rep]]);
+        for (const uint32_t m : members)
+            if (m != rep)
+                log.info("  {} (distance {})", paths[valid[m]],
+                         hamming(ok.at(m), ok.at(rep), words));
+    }
+
+    log.info("{} images: {} duplicate cluster(s), {} redundant image(s) within {} of {} bits",
+             ok.size(), dup_clusters, redundant, threshold, words * 64);
+    log.info("hashing {:.3f} s ({:.0f} images/s, {} worker(s)), search {:.3f} s", t_hash.count(),
+             paths.size() / t_hash.count(), sched::config().outer, t_search.count());
+    return valid.size() == paths.size() ? 0 : 1;
+}
+
+// Hashes/sec on synthetic frames, then queries/sec against `entries` random hashes with planted
+// near duplicates; a sample of queries is checked against the linear scan
+int run_bench(size_t entries, Method method, int words, int threshold, logger::Logger& log)
+{
+    std::vector<cv::Mat> frames(64);
+    for (auto& f : frames)
+    {
+        f.create(480, 640, CV_8UC3);
+        cv::randu(f, cv::Scalar::all(0), cv::Scalar::all(256));
+        cv::GaussianBlur(f, f, cv::Size(0, 0), 4.0);
+    }
+    std::vector<uint64_t> h(static_cast<size_t>(words));
+    const int hash_iters = 2000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < hash_iters; ++i)
+        compute_hash(frames[i % frames.size()], method, words, h.data());
+    const std::chrono::duration<double> t_hash = std::chrono::steady_clock::now() - t0;
+    log.info("bench: {} {}-bit {} of 640x480 frames: {:.0f} hashes/s", hash_iters, words * 64,
+             method == Method::DHash ? "dHash" : "pHash", hash_iters / t_hash.count());
+
+    // Every 100th entry is a copy of its predecessor with up to `threshold` bits flipped
+    std::mt19937_64 gen(42);
+    HashSet set;
+    set.words = words;
+    set.data.resize(entries * static_cast<size_t>(words));
+    for (size_t i = 0; i < entries; ++i)
+    {
+        uint64_t* e = set.data.data() + i * static_cast<size_t>(words);
+        if (i % 100 == 99)
+        {
+            std::copy(e - words, e, e);
+            for (int f = static_cast<int>(gen() % static_cast<uint64_t>(threshold + 1)); f > 0; --f)
+            {
+                const auto bit = static_cast<int>(gen() % static_cast<uint64_t>(words * 64));
+                e[bit / 64] ^= 1ULL << (bit % 64);
+            }
+        }
+        else
+            for (int w = 0; w < words; ++w)
+                e[w] = gen();
+    }
+
+    t0 = std::chrono::steady_clock::now();
+    MultiIndex index(set);
+    const std::chrono::duration<double> t_build = std::chrono::steady_clock::now() - t0;
+    log.info("bench: multi-index over {} entries ({} chunks) built in {:.3f} s", entries,
+             index.chunks(), t_build.count());
+
+    const size_t queries = std::min<size_t>(entries, 20000);
+    std::vector<uint32_t> hits;
+    size_t matches = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries; ++i)
+    {
+        index.query(set.at(gen() % entries), threshold, hits);
+        matches += hits.size();
+    }
+    const std::chrono::duration<double> t_query = std::chrono::steady_clock::now() - t0;
+
+    const size_t scans = std::min<size_t>(entries, 200);
+    std::vector<uint32_t> expect;
+    size_t mismatches = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < scans; ++i)
+    {
+        const uint64_t* q = set.at((i * 100 + 99) % entries);
+        linear_scan(set, q, threshold, expect);
+        index.query(q, threshold, hits);
+        std::sort(hits.begin(), hits.end());
+        mismatches += hits != expect ? 1 : 0;
+    }
+    const std::chrono::duration<double> t_scan = std::chrono::steady_clock::now() - t0;
+
+    log.info("bench: threshold {}: multi-index {:.0f} queries/s ({:.2f} matches/query)", threshold,
+             queries / t_query.count(), static_cast<double>(matches) / queries);
+    log.info("bench: linear SIMD scan {:.0f} queries/s; {}/{} sampled queries agree",
+             scans / t_scan.count(), scans - mismatches, scans);
+    return mismatches == 0 ? 0 : 1;
+}
+
+} // namespace
+
+static int dedupe_example(int argc, char** argv)
+{
+    logger::Logger log{"dedupe", logger::Level::INFO};
+
+    cli::ArgParser ap{"dedupe"};
+    ap.add_option("hash", 'H', "Perceptual hash: dhash or phash", "dhash");
+    ap.add_option("bits", 'b', "Hash size: 64 or 256", "64");
+    ap.add_option("threshold", 't', "Max Hamming distance of duplicates (default: 10 for 64-bit, "
+                                    "40 for 256-bit)");
+    ap.add_option("bench", 'B', "Benchmark: index size, e.g. 1000000 (0 = off)", "0");
+    ap.add_positional("path...", "Images and/or directories of images (default: assets)");
+    if (!ap.parse(argc, argv) || ap.help())
+    {
+        log.info("\n{}", ap.usage());
+        return ap.help() ? 0 : 2;
+    }
+    const std::string hash = ap.get_string("hash", "dhash");
+    const int bits = ap.get_int("bits", 64);
+    if ((hash != "dhash" && hash != "phash") || (bits != 64 && bits != 256))
+    {
+        log.error("expected --hash dhash|phash and --bits 64|256");
+        return 2;
+    }
+    const Method method = hash == "dhash" ? Method::DHash : Method::PHash;
+    const int words = bits / 64;
+    const int threshold = std::clamp(ap.get_int("threshold", bits == 64 ? 10 : 40), 0, bits);
+
+    if (const int entries = ap.get_int("bench", 0); entries > 0)
+        return run_bench(static_cast<size_t>(entries), method, words, threshold, log);
+
+    const auto paths = expand_inputs(ap.positionals().empty() ? std::vector<std::string>{"assets"}
+                                                              : ap.positionals());
+    if (paths.empty())
+    {
+        log.error("no images to compare");
+        return 1;
+    }
+    log.info("hashing {} images ({} {}-bit, threshold {})", paths.size(), hash, bits, threshold);
+    return run_dedupe(paths, method, words, threshold, log);
+}
+
+REGISTER_EXAMPLE("dedupe", dedupe_example, "Near-duplicate clusters via perceptual hashes");
@@ -2,43 +2,586 @@
  * \file
  * \ingroup examples
  * Canny edge detection with optional Gaussian blur.
+ *
+ * `--format png` (default) writes a full-frame overlay; `--format contours` writes only the
+ * traced edge polylines in the compact HWEC format (see contour_io.h). Passing several paths
+ * runs a batch whose file reads are prefetched (see prefetch.h). With the runner's `--cache`,
+ * outputs of unchanged inputs and options are restored instead of recomputed (result_cache.h).
+ * `--deadline-ms` runs a live feed (camera, video, or a still image replayed) that shrinks the
+ * working resolution to keep every frame within the budget. `--stream-mb` processes an image too
+ * large for memory as a sliding window of decoded strips (strip_io.h). A list or range in
+ * `--t1`/`--t2`/`--blur` sweeps the combinations, sharing blur and gradients per blur size.
  */
 #include "cli/argparse.h"
+#include "contour_io.h"
 #include "cv_util.h"
 #include "examples/registry.h"
+#include "frame_ring.h"
 #include "logger.h"
+#include "prefetch.h"
+#include "result_cache.h"
+#include "scheduler.h"
+#include "strip_io.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fmt/format.h>
+#include <memory>
+#include <mutex>
 #include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+#include <optional>
 #include <string>
+#include <sys/resource.h>
 #include <vector>
 
 using examples::ExampleFn;
 
-static int edges_example(int argc, char** argv)
+namespace
 {
-    logger::Logger log{"edges", logger::Level::INFO};
 
-    cli::ArgParser ap{"edges"};
-    ap.add_option("t1", 'l', "Canny lower threshold", "100");
-    ap.add_option("t2", 'u', "Canny upper threshold", "200");
-    ap.add_option("blur", 'b', "Gaussian blur kernel size (odd)", "3");
-    ap.add_positional("path", "Image path (default: assets/lena_img.png)");
-    if (!ap.parse(argc, argv) || ap.help())
+// Bump when the output for the same input and options changes; part of every cache key
+constexpr const char* kCacheVersion = "edges/1";
+
+struct Params
+{
+    int t1 = 100;
+    int t2 = 200;
+    int blur = 3;
+    std::string format = "png";
+    double epsilon = 0.0;
+};
+
+// The threshold-independent front of detect(): optional blur, then gray
+cv::Mat smoothed_gray(const cv::Mat& src, int blur)
+{
+    cv::Mat work = src;
+    if (blur > 0)
     {
-        log.info("\n{}", ap.usage());
-        return ap.help() ? 0 : 2;
+        cv::GaussianBlur(src, work, cv::Size(blur, blur), 0);
     }
-    std::string path =
-        ap.positionals().empty() ? std::string{"assets/lena_img.png"} : ap.positionals().front();
-    int t1 = std::max(0, ap.get_int("t1", 100));
-    int t2 = std::max(0, ap.get_int("t2", 200));
-    int blur = std::max(0, ap.get_int("blur", 3));
-    if (blur % 2 == 0 && blur > 0)
-        ++blur;
 
-    log.info("loading {} (t1={}, t2={}, blur={})", path, t1, t2, blur);
+    cv::Mat gray = work;
+    if (work.channels() != 1)
+        cv::cvtColor(work, gray, cv::COLOR_BGR2GRAY);
+    return gray;
+}
+
+cv::Mat detect(const cv::Mat& src, const Params& p)
+{
+    cv::Mat edges;
+    cv::Canny(smoothed_gray(src, p.blur), edges, p.t1, p.t2);
+    return edges;
+}
+
+// Cache key options: the effective parameters after clamping and rounding, so spellings that
+// produce the same output (`--blur 2` and `--blur 3`) share an entry. Performance, live,
+// streaming and sweep settings never reach a cached run and are not part of it.
+std::string cache_options(const Params& p)
+{
+    return fmt::format("t1={};t2={};blur={};format={};simplify={}", p.t1, p.t2, p.blur, p.format,
+                       p.epsilon);
+}
+
+std::string output_path(const std::string& stem, const Params& p)
+{
+    return stem + (p.format == "contours" ? ".hwec" : ".png");
+}
+
+// Write `<stem>.png` or `<stem>.hwec`; with display set, show the overlay instead if possible
+int write_outputs(const cv::Mat& src, const cv::Mat& edges, const Params& p,
+                  const std::string& stem, bool display, logger::Logger& log)
+{
+    // Edge geometry drives both outputs; the overlay only touches edge coordinates
+    auto geom = contour_io::trace(edges);
+    contour_io::simplify(geom, p.epsilon);
+
+    if (p.format == "contours")
+    {
+        const std::string out = output_path(stem, p);
+        const auto t0 = std::chrono::steady_clock::now();
+        const size_t bytes = contour_io::write(out, geom);
+        if (bytes == 0)
+        {
+            log.error("failed to write {}", out);
+            return 1;
+        }
+        const std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t0;
+        log.info("wrote {} ({} polylines, {} points, {} bytes) in {:.3f} ms", out,
+                 geom.polylines.size(), geom.point_count(), bytes, dt.count());
+        // Nothing left to do without a window: skip building the full-frame overlay
+        if (!display || !cv_util::hasGui())
+            return 0;
+    }
+
+    // Visualize: paint edges in red over original
+    cv::Mat vis = src.clone();
+    contour_io::draw(vis, geom, cv::Scalar(0, 0, 255));
+
+    if (!display || !cv_util::quickDisplay(vis, "Edges", 0, true, 1024, 768))
+    {
+        const std::string out = output_path(stem, p);
+        if (!cv::imwrite(out, vis))
+        {
+            log.error("failed to write {}", out);
+            return 1;
+        }
+        if (display)
+            log.warn("headless environment; wrote {}", out);
+        else
+            log.info("wrote {}", out);
+    }
+    return 0;
+}
+
+// Batch: reads run `window` files ahead of decode + detect through the prefetcher. Files are
+// handed out in input order to the runner's outer workers (sched::run_workers, `--threads`),
+// each of which decodes, detects and writes its file independently.
+int run_batch(const std::vector<std::string>& paths, const Params& p, size_t window,
+              const std::string& options, logger::Logger& log)
+{
+    prefetch::Options opts;
+    opts.window = window;
+    prefetch::Prefetcher pf(paths, opts);
+
+    std::atomic<int> rc{0};
+    std::mutex next_mu; // the prefetcher has a single consumer side
+    size_t index = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    sched::run_workers(
+        [&](int)
+        {
+            prefetch::Buffer buf;
+            for (;;)
+            {
+                std::string stem;
+                {
+                    std::lock_guard<std::mutex> lock(next_mu);
+                    if (!pf.next(buf))
+                        return;
+                    stem = fmt::format("output_edges_{:04d}", index++);
+                }
+                if (!buf.error.empty())
+                {
+                    log.error("{}", buf.error);
+                    rc = 1;
+                    continue;
+                }
+
+                // The prefetched bytes are hashed in place; a hit skips decode and detection
+                std::optional<result_cache::Key> key;
+                if (result_cache::enabled())
+                {
+                    key = result_cache::make_key("edges", kCacheVersion, options,
+                                                 buf.bytes.data(), buf.bytes.size());
+                    if (result_cache::restore(*key, {output_path(stem, p)}))
+                    {
+                        log.info("cache hit: {} -> {}", buf.path, output_path(stem, p));
+                        continue;
+                    }
+                }
+
+                cv::Mat src;
+                try
+                {
+                    src = cv_util::decode(buf.bytes, buf.path);
+                }
+                catch (const std::exception& e)
+                {
+                    log.error("{}", e.what());
+                    rc = 1;
+                    continue;
+                }
+                if (write_outputs(src, detect(src, p), p, stem, false, log) != 0)
+                    rc = 1;
+                else if (key)
+                    result_cache::store(*key, {output_path(stem, p)});
+            }
+        });
+    const std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+
+    const auto s = pf.stats();
+    log.info("batch: {} files, {:.1f} MiB in {:.3f} s ({:.1f} files/s, {} worker(s))", s.files,
+             s.bytes / (1024.0 * 1024.0), dt.count(), s.files / dt.count(),
+             sched::config().outer);
+    log.info("prefetch [{}]: window={}, queue depth avg={:.2f} max={}, stalled {:.3f} ms",
+             s.backend, window, s.avg_depth, s.max_depth, s.stall_ms);
+    return rc.load();
+}
+
+// Deadline mode: Canny and the blur cost roughly in proportion to the pixel count, so the EMA of
+// recent frame times (at the current scale) is normalized by scale^2 to estimate the full-size
+// cost, and the next scale is the largest one expected to land at kHeadroom of the budget.
+struct DeadlineControl
+{
+    static constexpr double kAlpha = 0.25;   // EMA weight of the newest frame
+    static constexpr double kHeadroom = 0.8; // aim below the deadline to absorb jitter
+    static constexpr double kStep = 0.05;    // scale granularity, avoids resizing on noise
+
+    double deadline_ms = 0.0;
+    double min_scale = 0.25;
+    double scale = 1.0;
+    double ema_ms = 0.0;
+
+    void update(double ms)
+    {
+        ema_ms = ema_ms == 0.0 ? ms : kAlpha * ms + (1.0 - kAlpha) * ema_ms;
+        const double full_ms = ema_ms / (scale * scale);
+        double next = std::sqrt(kHeadroom * deadline_ms / std::max(full_ms, 1e-3));
+        next = std::clamp(std::floor(next / kStep) * kStep, min_scale, 1.0);
+        // Carry the estimate over to the new scale instead of waiting for it to re-converge
+        ema_ms *= (next * next) / (scale * scale);
+        scale = next;
+    }
+};
+
+// Blur kernel for a working scale: shrinks with the image (odd), dropped once below 3
+int blur_at(int blur, double scale)
+{
+    if (blur == 0 || scale >= 1.0)
+        return blur;
+    const int k = static_cast<int>(std::lround(blur * scale)) | 1;
+    return k < 3 ? 0 : k;
+}
+
+// Detect at `scale` of the frame and bring the edge mask back to full size
+cv::Mat detect_scaled(const cv::Mat& src, Params p, double scale)
+{
+    p.blur = blur_at(p.blur, scale);
+    if (scale >= 1.0)
+        return detect(src, p);
+
+    cv::Mat small;
+    cv::resize(src, small, cv::Size(), scale, scale, cv::INTER_AREA);
+    cv::Mat edges;
+    cv::resize(detect(small, p), edges, src.size(), 0, 0, cv::INTER_NEAREST);
+    return edges;
+}
+
+// Live feed with a per-frame latency budget. `source` is a camera index, a video (or anything
+// else cv::VideoCapture opens), `shm:<name>` for a frame ring (always taking the newest frame),
+// or a still image that is replayed `frames` times.
+int run_deadline(const std::string& source, const Params& p, double deadline_ms, int frames,
+                 double min_scale, logger::Logger& log)
+{
+    cv::VideoCapture cap;
+    std::unique_ptr<frame_ring::Reader> ring;
+    frame_ring::Frame ring_frame;
+    cv::Mat still;
+    const bool camera = cv_util::isCameraIndex(source);
+    if (source.rfind("shm:", 0) == 0)
+    {
+        try
+        {
+            ring = std::make_unique<frame_ring::Reader>(source.substr(4));
+        }
+        catch (const std::exception& e)
+        {
+            log.error("{}", e.what());
+            return 1;
+        }
+    }
+    else if (!camera && cv::haveImageReader(source))
+    {
+        try
+        {
+            still = cv_util::load(source);
+        }
+        catch (const std::exception& e)
+        {
+            log.error("{}", e.what());
+            return 1;
+        }
+    }
+    else if (camera ? !cap.open(std::stoi(source)) : !cap.open(source))
+    {
+        log.error("cannot open video source {}", source);
+        return 1;
+    }
+    if (!still.empty() && frames == 0)
+        frames = 100;
+
+    DeadlineControl ctl;
+    ctl.deadline_ms = deadline_ms;
+    ctl.min_scale = min_scale;
+    const bool gui = cv_util::hasGui();
+
+    int count = 0;
+    int misses = 0;
+    double scale_sum = 0.0;
+    cv::Mat frame;
+    cv::Mat vis;        // with a GUI: this frame's overlay
+    cv::Mat last;       // headless: the frame the output is drawn from
+    cv::Mat last_edges; // and its edges
+    while (frames == 0 || count < frames)
+    {
+        if (ring)
+        {
+            // Behind the producer: drop the backlog rather than fall further behind
+            if (!ring->acquire(ring_frame, 1000, true))
+                break;
+            frame = ring_frame.image;
+        }
+        else if (!still.empty())
+            frame = still;
+        else if (!cap.read(frame) || frame.empty())
+            break;
+
+        // The budget covers everything done per frame, overlay and display included
+        const double scale = ctl.scale;
+        const auto t0 = std::chrono::steady_clock::now();
+        bool quit = false;
+        try
+        {
+            // Ring frames come as published; give them the layout cv_util::load would
+            if (ring)
+                frame = frame_ring::as_imread(frame, cv::IMREAD_COLOR);
+            const cv::Mat edges = detect_scaled(frame, p, scale);
+            if (gui)
+            {
+                frame.copyTo(vis);
+                contour_io::draw(vis, contour_io::trace(edges), cv::Scalar(0, 0, 255));
+                cv::imshow("Edges (live)", vis);
+                quit = cv::waitKey(1) == 27; // Esc
+            }
+            else if (frames == 0 || count + 1 == frames)
+            {
+                // Headless output is the last frame only; if the source decides which one that
+                // is, copy each frame into a reused buffer (the ring slot is released next)
+                frame.copyTo(last);
+                last_edges = edges;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            log.error("frame {}: {}", count + 1, e.what());
+            return 1;
+        }
+        const std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t0;
+
+        ++count;
+        const bool miss = dt.count() > deadline_ms;
+        misses += miss ? 1 : 0;
+        scale_sum += scale;
+        ctl.update(dt.count());
+        log.info("frame {:5d}: {:7.2f} ms{} scale={:.2f} blur={} | missed {}/{} ({:.1f}%)", count,
+                 dt.count(), miss ? " MISS" : "     ", scale, blur_at(p.blur, scale), misses, count,
+                 100.0 * misses / count);
+        if (quit)
+            break;
+    }
+    if (count == 0)
+    {
+        log.error("no frames read from {}", source);
+        return 1;
+    }
+
+    log.info("deadline {:.1f} ms: {} frames, {} missed ({:.1f}%), mean scale {:.2f}", deadline_ms,
+             count, misses, 100.0 * misses / count, scale_sum / count);
+    if (ring)
+        log.info("frame ring: skipped {} stale frame(s)", ring->skipped());
+    if (!gui && !last.empty())
+    {
+        contour_io::draw(last, contour_io::trace(last_edges), cv::Scalar(0, 0, 255));
+        if (!cv::imwrite("output_edges_live.png", last))
+        {
+            log.error("failed to write output_edges_live.png");
+            return 1;
+        }
+        log.warn("headless environment; wrote last frame to output_edges_live.png");
+    }
+    return 0;
+}
+
+// Rows of context above and below each output strip so it matches a whole-image run: blur
+// radius, Sobel (1) and non-maximum suppression (1), plus `extra` for hysteresis, whose edge
+// chains are not bounded in length
+int stream_halo(const Params& p, int extra)
+{
+    return p.blur / 2 + 2 + extra;
+}
+
+// Working set per window row: source, blurred copy, gray, Canny's 16-bit dx/dy and edge maps
+size_t stream_row_bytes(int width, int channels)
+{
+    return static_cast<size_t>(width) * (2 * channels + 1 + 4 + 1 + 1);
+}
+
+// Stream a huge image: decode strips into a window of rows sized by `budget` bytes, detect on the
+// whole window, write the rows that have full context on both sides, then slide the window so
+// the last 2 * halo rows become its top. Memory depends on the width and budget, not the height.
+int run_stream(const std::string& path, const Params& p, size_t budget, int extra,
+               logger::Logger& log)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    const std::string out = std::string{"output_edges_stream"} + strip_io::gray_extension();
+    int strips = 0;
+    try
+    {
+        strip_io::Reader in(path);
+        const strip_io::Info& info = in.info();
+        const int halo = stream_halo(p, extra);
+        const size_t row_bytes = stream_row_bytes(info.width, info.channels);
+        const int rows = static_cast<int>(
+            std::min(budget / row_bytes, static_cast<size_t>(info.height)));
+        if (rows < info.height && rows <= 2 * halo)
+        {
+            log.error("--stream-mb too small for a {} px wide image: need at least {:.1f} MiB",
+                      info.width, (2 * halo + 1) * row_bytes / (1024.0 * 1024.0));
+            return 2;
+        }
+        log.info("streaming {} ({} {}x{}) to {}: {}-row window, {} rows of context, ~{:.1f} MiB",
+                 path, info.format, info.width, info.height, out, rows, halo,
+                 rows * row_bytes / (1024.0 * 1024.0));
+
+        strip_io::Writer writer(out, info.width, info.height, 1);
+        cv::Mat window(rows, info.width, CV_8UC(info.channels));
+        int top = 0;    // image row held in window row 0
+        int filled = 0; // window rows holding decoded data
+        for (;;)
+        {
+            filled += in.read(window.rowRange(filled, rows));
+            const int end = top + filled;
+            // A fresh header over the filled rows, not a ROI: OpenCV filters read real pixels
+            // beyond a ROI's edge, and rows past `filled` hold stale data from an earlier window
+            const cv::Mat filled_rows(filled, info.width, window.type(), window.data,
+                                      window.step[0]);
+            const cv::Mat edges = detect(filled_rows, p);
+            // Rows next to a window edge lack context unless that edge is the image border
+            const int first = top == 0 ? 0 : halo;
+            const int last = end == info.height ? filled : filled - halo;
+            writer.write(edges.rowRange(first, last));
+            ++strips;
+            if (end == info.height)
+                break;
+
+            const int keep = 2 * halo;
+            std::memmove(window.ptr(0), window.ptr(filled - keep), keep * window.step[0]);
+            top = end - keep;
+            filled = keep;
+        }
+        writer.finish();
+    }
+    catch (const std::exception& e)
+    {
+        log.error("{}", e.what());
+        return 1;
+    }
+    const std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+
+    rusage ru = {};
+    getrusage(RUSAGE_SELF, &ru);
+    log.info("wrote {} in {} strips, {:.3f} s; peak RSS {:.1f} MiB (budget {:.1f} MiB)", out,
+             strips, dt.count(), ru.ru_maxrss / 1024.0, budget / (1024.0 * 1024.0));
+    return 0;
+}
+
+// Sweep values: comma-separated non-negative integers and inclusive ranges `lo:hi[:step]`, e.g.
+// "50,100:200:50"
+bool parse_sweep(const std::string& s, std::vector<int>& out)
+{
+    const auto to_int = [](const std::string& t, int& v)
+    {
+        try
+        {
+            size_t pos = 0;
+            v = std::stoi(t, &pos);
+            return pos == t.size();
+        }
+        catch (...)
+        {
+            return false;
+        }
+    };
+    out.clear();
+    for (size_t begin = 0; begin <= s.size();)
+    {
+        const size_t end = std::min(s.find(',', begin), s.size());
+        const std::string item = s.substr(begin, end - begin);
+        begin = end + 1;
+
+        int lo = 0;
+        const size_t c1 = item.find(':');
+        if (c1 == std::string::npos)
+        {
+            if (!to_int(item, lo) || lo < 0)
+                return false;
+            out.push_back(lo);
+            continue;
+        }
+        const size_t c2 = item.find(':', c1 + 1);
+        int hi = 0;
+        int step = 1;
+        if (!to_int(item.substr(0, c1), lo) ||
+            !to_int(item.substr(c1 + 1, c2 == std::string::npos ? c2 : c2 - c1 - 1), hi) ||
+            (c2 != std::string::npos && !to_int(item.substr(c2 + 1), step)) || lo < 0 ||
+            step <= 0 || hi < lo)
+            return false;
+        // Count steps in 64 bits: stepping an int towards INT_MAX would overflow
+        const int64_t n = (static_cast<int64_t>(hi) - lo) / step;
+        if (n >= 1000)
+            return false;
+        for (int64_t k = 0; k <= n; ++k)
+            out.push_back(static_cast<int>(lo + k * step));
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return !out.empty();
+}
+
+// Upper bound on sweep combinations (blur sizes x threshold pairs)
+constexpr size_t kMaxSweep = 1024;
 
+struct SweepRun
+{
+    int blur = 0;
+    int t1 = 0;
+    int t2 = 0;
+    double ms = 0.0; // threshold-dependent stage only
+    double density = 0.0;
+    cv::Mat edges; // full size, or the contact sheet tile
+};
+
+// Contact sheet of tiles: one row per (blur, t1), one column per t2; t1 > t2 cells stay empty
+cv::Mat contact_sheet(const std::vector<SweepRun>& runs, const std::vector<int>& t2s,
+                      cv::Size tile)
+{
+    constexpr int kLabel = 16;
+    const cv::Size cell(tile.width + 2, tile.height + kLabel + 2);
+    std::vector<std::pair<int, int>> rows;
+    for (const auto& r : runs)
+        if (rows.empty() || rows.back() != std::make_pair(r.blur, r.t1))
+            rows.emplace_back(r.blur, r.t1);
+
+    cv::Mat sheet(cell.height * static_cast<int>(rows.size()),
+                  cell.width * static_cast<int>(t2s.size()), CV_8UC1, cv::Scalar(0));
+    for (const auto& r : runs)
+    {
+        const auto row = std::find(rows.begin(), rows.end(), std::make_pair(r.blur, r.t1));
+        const auto col = std::lower_bound(t2s.begin(), t2s.end(), r.t2);
+        const cv::Point at(static_cast<int>(col - t2s.begin()) * cell.width + 1,
+                           static_cast<int>(row - rows.begin()) * cell.height + 1);
+        cv::putText(sheet, fmt::format("b{} {}/{} {:.1f}ms", r.blur, r.t1, r.t2, r.ms),
+                    at + cv::Point(2, kLabel - 4), cv::FONT_HERSHEY_SIMPLEX, 0.35,
+                    cv::Scalar(160));
+        cv::Mat dst = sheet(cv::Rect(at + cv::Point(0, kLabel), tile));
+        r.edges.copyTo(dst);
+    }
+    return sheet;
+}
+
+// Threshold sweep: blur, gray and the Sobel gradients depend only on the blur size, so they are
+// computed once per blur; each (t1, t2) pair then runs just Canny's threshold-dependent stage
+// (non-maximum suppression and hysteresis) on the shared gradients, pairs in parallel. The
+// gradients match Canny's own (3x3 Sobel, replicated border), so each result equals a single run.
+int run_sweep(const std::string& path, const std::vector<int>& blurs, const std::vector<int>& t1s,
+              const std::vector<int>& t2s, const Params& p, bool sheet, logger::Logger& log)
+{
+    const auto t0 = std::chrono::steady_clock::now();
     cv::Mat src;
     try
     {
@@ -49,34 +592,266 @@ static int edges_example(int argc, char** argv)
         log.error("{}", e.what());
         return 1;
     }
+    const std::chrono::duration<double, std::milli> t_load = std::chrono::steady_clock::now() - t0;
 
-    cv::Mat work = src;
-    if (blur > 0)
+    // Canny swaps t1 > t2, so those pairs would only repeat t2/t1
+    size_t pairs = 0;
+    for (const int t1 : t1s)
+        pairs += static_cast<size_t>(t2s.end() - std::lower_bound(t2s.begin(), t2s.end(), t1));
+    if (pairs * blurs.size() > kMaxSweep)
     {
-        cv::GaussianBlur(src, work, cv::Size(blur, blur), 0);
+        log.error("{} combinations requested; a sweep runs at most {}", pairs * blurs.size(),
+                  kMaxSweep);
+        return 2;
+    }
+    std::vector<SweepRun> runs;
+    for (const int b : blurs)
+        for (const int t1 : t1s)
+            for (const int t2 : t2s)
+                if (t1 <= t2)
+                    runs.push_back({b, t1, t2});
+    if (runs.empty())
+    {
+        log.error("no threshold pair with t1 <= t2");
+        return 2;
     }
+    log.info("sweeping {} ({}x{}): {} combination(s) over {} blur size(s)", path, src.cols,
+             src.rows, runs.size(), blurs.size());
 
-    cv::Mat gray;
-    cv::cvtColor(work, gray, cv::COLOR_BGR2GRAY);
-    cv::Mat edges;
-    cv::Canny(gray, edges, t1, t2);
+    const double scale = std::min(1.0, 256.0 / std::max(src.cols, src.rows));
+    const cv::Size tile(std::max(1, static_cast<int>(std::lround(src.cols * scale))),
+                        std::max(1, static_cast<int>(std::lround(src.rows * scale))));
+    std::atomic<bool> failed{false};
+    double t_prep = 0.0;
+    double t_thresh = 0.0;
+    double t_separate = 0.0; // the same work as one edges run per combination
+    const auto t1_all = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < runs.size();)
+    {
+        const int blur = runs[first].blur;
+        size_t last = first;
+        while (last < runs.size() && runs[last].blur == blur)
+            ++last;
 
-    // Visualize: paint edges in red over original
-    cv::Mat vis = src.clone();
-    vis.setTo(cv::Scalar(0, 0, 255), edges);
+        const auto tp = std::chrono::steady_clock::now();
+        const cv::Mat gray = smoothed_gray(src, blur);
+        cv::Mat dx, dy;
+        cv::Sobel(gray, dx, CV_16S, 1, 0, 3, 1, 0, cv::BORDER_REPLICATE);
+        cv::Sobel(gray, dy, CV_16S, 0, 1, 3, 1, 0, cv::BORDER_REPLICATE);
+        const std::chrono::duration<double, std::milli> prep =
+            std::chrono::steady_clock::now() - tp;
+        t_prep += prep.count();
+        t_separate += (last - first) * (t_load.count() + prep.count());
 
-    if (!cv_util::quickDisplay(vis, "Edges", 0, true, 1024, 768))
+        const auto run_pair = [&](size_t i)
+        {
+            SweepRun& r = runs[i];
+            const auto tc = std::chrono::steady_clock::now();
+            cv::Mat edges;
+            cv::Canny(dx, dy, edges, r.t1, r.t2);
+            const std::chrono::duration<double, std::milli> dt =
+                std::chrono::steady_clock::now() - tc;
+            r.ms = dt.count();
+            r.density = cv::countNonZero(edges) / static_cast<double>(edges.total());
+            // Only the tile (or nothing, once written) outlives the pair
+            if (sheet)
+                cv::resize(edges, r.edges, tile, 0, 0, cv::INTER_AREA);
+            else if (write_outputs(src, edges, p,
+                                   fmt::format("output_edges_b{}_t{}_{}", r.blur, r.t1, r.t2),
+                                   false, log) != 0)
+                failed = true;
+        };
+        // Pairs are the outer level: with an explicit `--threads` split the runner's workers
+        // take them one at a time; by default they spread over OpenCV's pool (Canny calls made
+        // from inside it run single-threaded, so the two levels do not oversubscribe)
+        if (sched::config().explicit_split)
+        {
+            std::atomic<size_t> next{first};
+            sched::run_workers(
+                [&](int)
+                {
+                    for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < last;)
+                        run_pair(i);
+                });
+        }
+        else
+        {
+            cv::parallel_for_(cv::Range(static_cast<int>(first), static_cast<int>(last)),
+                              [&](const cv::Range& range)
+                              {
+                                  for (int i = range.start; i < range.end; ++i)
+                                      run_pair(static_cast<size_t>(i));
+                              });
+        }
+        for (size_t i = first; i < last; ++i)
+        {
+            log.info("blur {:>2} t1 {:>4} t2 {:>4}: {:7.2f} ms, {:5.2f}% edge pixels", blur,
+                     runs[i].t1, runs[i].t2, runs[i].ms, 100.0 * runs[i].density);
+            t_thresh += runs[i].ms;
+        }
+        log.info("blur {:>2}: shared blur + gray + gradients {:.2f} ms", blur, prep.count());
+        first = last;
+    }
+    const std::chrono::duration<double, std::milli> t_sweep =
+        std::chrono::steady_clock::now() - t1_all;
+
+    // One edges run per combination would redo decode, blur, gray and Sobel every time
+    const double separate = t_separate + t_thresh;
+    log.info("sweep {:.1f} ms wall (load {:.1f}, shared stages {:.1f}, thresholds {:.1f} ms "
+             "summed); ~{:.1f} ms as {} separate runs",
+             t_load.count() + t_sweep.count(), t_load.count(), t_prep, t_thresh, separate,
+             runs.size());
+
+    if (!sheet)
+        return failed ? 1 : 0;
+    const cv::Mat vis = contact_sheet(runs, t2s, tile);
+    if (!cv_util::quickDisplay(vis, "Edges sweep", 0, true, 1024, 768))
     {
-        const std::string out = "output_edges.png";
+        const std::string out = "output_edges_sweep.png";
         if (!cv::imwrite(out, vis))
         {
             log.error("failed to write {}", out);
             return 1;
         }
-        log.warn("headless environment; wrote {}", out);
+        log.info("wrote {} ({} tiles of {}x{})", out, runs.size(), tile.width, tile.height);
     }
-
     return 0;
 }
 
+} // namespace
+
+static int edges_example(int argc, char** argv)
+{
+    logger::Logger log{"edges", logger::Level::INFO};
+
+    cli::ArgParser ap{"edges"};
+    ap.add_option("t1", 'l', "Canny lower threshold (list/range such as 50,100:200:50 sweeps)",
+                  "100");
+    ap.add_option("t2", 'u', "Canny upper threshold (list/range sweeps)", "200");
+    ap.add_option("blur", 'b', "Gaussian blur kernel size, odd (list/range sweeps)", "3");
+    ap.add_option("format", 'f', "Output format: png (overlay) or contours (HWEC polylines)",
+                  "png");
+    ap.add_option("simplify", 's', "Douglas-Peucker epsilon in pixels for contours (0 = lossless)",
+                  "0");
+    ap.add_option("prefetch", 'p', "Batch mode: files read ahead of processing", "8");
+    ap.add_option("deadline-ms", 'd',
+                  "Live mode: per-frame budget in ms; path is a camera index, video or image "
+                  "(0 = off)",
+                  "0");
+    ap.add_option("frames", 'n', "Live mode: stop after N frames (0 = until the source ends; a "
+                                 "still image is replayed 100 times)",
+                  "0");
+    ap.add_option("min-scale", 'm', "Live mode: smallest working scale", "0.25");
+    ap.add_option("stream-mb", 'M',
+                  "Stream one huge image in strips within this many MiB of working memory "
+                  "(0 = off)",
+                  "0");
+    ap.add_option("context", 'c', "Streaming: extra context rows for hysteresis", "16");
+    ap.add_option("sweep-out", 'o',
+                  "Sweep: sheet (one contact sheet) or files (one output per combination)",
+                  "sheet");
+    ap.add_positional("path...", "Image path(s) (default: assets/lena_img.png)");
+    if (!ap.parse(argc, argv) || ap.help())
+    {
+        log.info("\n{}", ap.usage());
+        return ap.help() ? 0 : 2;
+    }
+    Params p;
+    p.t1 = std::max(0, ap.get_int("t1", 100));
+    p.t2 = std::max(0, ap.get_int("t2", 200));
+    p.blur = std::max(0, ap.get_int("blur", 3));
+    if (p.blur % 2 == 0 && p.blur > 0)
+        ++p.blur;
+    p.format = ap.get_string("format", "png");
+    p.epsilon = std::max(0.0, ap.get_double("simplify", 0.0));
+    if (p.format != "png" && p.format != "contours")
+    {
+        log.error("unknown --format '{}' (expected png or contours)", p.format);
+        return 2;
+    }
+
+    // A list or range in any of the Canny parameters selects the sweep
+    const std::string specs[] = {ap.get_string("t1", "100"), ap.get_string("t2", "200"),
+                                 ap.get_string("blur", "3")};
+    const auto is_sweep = [](const std::string& v) { return v.find_first_of(",:") != v.npos; };
+    if (std::any_of(std::begin(specs), std::end(specs), is_sweep))
+    {
+        std::vector<int> t1s, t2s, blurs;
+        const std::string out = ap.get_string("sweep-out", "sheet");
+        if (!parse_sweep(specs[0], t1s) || !parse_sweep(specs[1], t2s) ||
+            !parse_sweep(specs[2], blurs) || (out != "sheet" && out != "files"))
+        {
+            log.error("expected --t1/--t2/--blur as N, A,B,... or LO:HI[:STEP] (all >= 0) and "
+                      "--sweep-out sheet|files");
+            return 2;
+        }
+        for (auto& b : blurs)
+            b = b > 0 && b % 2 == 0 ? b + 1 : std::max(0, b);
+        std::sort(blurs.begin(), blurs.end());
+        blurs.erase(std::unique(blurs.begin(), blurs.end()), blurs.end());
+        const std::string path = ap.positionals().empty() ? std::string{"assets/lena_img.png"}
+                                                          : ap.positionals().front();
+        return run_sweep(path, blurs, t1s, t2s, p, out == "sheet", log);
+    }
+
+    if (const double deadline = ap.get_double("deadline-ms", 0.0); deadline > 0.0)
+    {
+        const std::string source = ap.positionals().empty() ? std::string{"assets/lena_img.png"}
+                                                            : ap.positionals().front();
+        log.info("live {} (t1={}, t2={}, blur={}, deadline={:.1f} ms)", source, p.t1, p.t2,
+                 p.blur, deadline);
+        return run_deadline(source, p, deadline, std::max(0, ap.get_int("frames", 0)),
+                            std::clamp(ap.get_double("min-scale", 0.25), 0.05, 1.0), log);
+    }
+
+    if (const int budget_mb = ap.get_int("stream-mb", 0); budget_mb > 0)
+    {
+        const std::string path = ap.positionals().empty() ? std::string{"assets/lena_img.png"}
+                                                          : ap.positionals().front();
+        return run_stream(path, p, static_cast<size_t>(budget_mb) << 20,
+                          std::max(0, ap.get_int("context", 16)), log);
+    }
+
+    const std::string options = cache_options(p);
+
+    if (ap.positionals().size() > 1)
+    {
+        log.info("batch of {} images (t1={}, t2={}, blur={})", ap.positionals().size(), p.t1, p.t2,
+                 p.blur);
+        const auto window = static_cast<size_t>(std::max(1, ap.get_int("prefetch", 8)));
+        return run_batch(ap.positionals(), p, window, options, log);
+    }
+
+    std::string path =
+        ap.positionals().empty() ? std::string{"assets/lena_img.png"} : ap.positionals().front();
+
+    // Only file outputs can be cached; an interactive PNG run shows a window instead
+    std::optional<result_cache::Key> key;
+    if (p.format == "contours" || !cv_util::hasGui())
+        key = result_cache::make_key_for_file("edges", kCacheVersion, options, path);
+    if (key && result_cache::restore(*key, {output_path("output_edges", p)}))
+    {
+        log.info("cache hit: {} -> {}", path, output_path("output_edges", p));
+        return 0;
+    }
+
+    log.info("loading {} (t1={}, t2={}, blur={})", path, p.t1, p.t2, p.blur);
+
+    cv::Mat src;
+    try
+    {
+        src = cv_util::load(path);
+    }
+    catch (const std::exception& e)
+    {
+        log.error("{}", e.what());
+        return 1;
+    }
+
+    const int rc = write_outputs(src, detect(src, p), p, "output_edges", true, log);
+    if (rc == 0 && key)
+        result_cache::store(*key, {output_path("output_edges", p)});
+    return rc;
+}
+
 REGISTER_EXAMPLE("edges", edges_example, "Canny edge detection with --t1/--t2/--blur");
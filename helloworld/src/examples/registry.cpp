@@ -1,6 +1,12 @@
 #include "examples/registry.h"
 
 #include <algorithm>
+#include <deque>
+#include <dlfcn.h>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
 
 namespace examples
 {
@@ -11,6 +17,20 @@ static std::vector<Item>& registry()
     return items;
 }
 
+// Backing storage for manifest strings; Item only holds const char* views into it
+static std::deque<std::string>& manifest_strings()
+{
+    static std::deque<std::string> strings;
+    return strings;
+}
+
+static const char* intern(std::string s)
+{
+    auto& store = manifest_strings();
+    store.push_back(std::move(s));
+    return store.back().c_str();
+}
+
 void register_example(const Item& item)
 {
     auto& r = registry();
@@ -37,6 +57,75 @@ const Item* find(std::string_view name)
     return nullptr;
 }
 
+size_t load_manifests(const std::string& dir)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec))
+        return 0;
+
+    // Sort so --list output does not depend on directory order
+    std::vector<fs::path> manifests;
+    for (const auto& entry : fs::directory_iterator(dir, ec))
+    {
+        if (entry.is_regular_file(ec) && entry.path().extension() == ".example")
+            manifests.push_back(entry.path());
+    }
+    std::sort(manifests.begin(), manifests.end());
+
+    size_t added = 0;
+    for (const auto& path : manifests)
+    {
+        std::ifstream in(path);
+        std::map<std::string, std::string> kv;
+        for (std::string line; std::getline(in, line);)
+        {
+            auto eq = line.find('=');
+            if (eq != std::string::npos)
+                kv[line.substr(0, eq)] = line.substr(eq + 1);
+        }
+        if (kv["name"].empty() || kv["library"].empty() || find(kv["name"]))
+            continue;
+        Item item{intern(kv["name"]), nullptr, intern(kv["help"]),
+                  intern((path.parent_path() / kv["library"]).string())};
+        register_example(item);
+        ++added;
+    }
+    return added;
+}
+
+ExampleFn* resolve(const Item& item, std::string* error)
+{
+    if (item.fn || !item.library)
+        return item.fn;
+
+    // Plugins stay loaded for the lifetime of the process; the cache also keeps repeated
+    // resolves (e.g. `--example all` reruns) from reopening the same object
+    static std::mutex mu;
+    static std::map<std::string, ExampleFn*> loaded;
+    std::lock_guard<std::mutex> lock(mu);
+    if (auto it = loaded.find(item.library); it != loaded.end())
+        return it->second;
+
+    void* handle = dlopen(item.library, RTLD_NOW | RTLD_LOCAL);
+    if (!handle)
+    {
+        if (error)
+            *error = dlerror();
+        return nullptr;
+    }
+    auto* fn = reinterpret_cast<ExampleFn*>(dlsym(handle, kPluginEntry));
+    if (!fn)
+    {
+        if (error)
+            *error = std::string{item.library} + ": missing symbol " + kPluginEntry;
+        dlclose(handle);
+        return nullptr;
+    }
+    loaded[item.library] = fn;
+    return fn;
+}
+
 Registrar::Registrar(Item item)
 {
     register_example(item);
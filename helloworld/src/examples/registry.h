@@ -11,6 +11,11 @@
 
 /** \defgroup engine Engine
  *  Core plumbing for the example runner (registry + bootstrap).
+ *
+ *  Examples are either linked into the runner and registered at static-init time, or (with
+ *  `-DHELLOWORLD_PLUGINS=ON`) built as one shared object each next to a `<name>.example`
+ *  manifest. Manifests are plain `key=value` lines (`name`, `help`, `library`); only the plugin
+ *  of the example actually being run is `dlopen`ed.
  */
 
 namespace examples
@@ -21,11 +26,15 @@ using ExampleFn = int(int argc, char** argv);
 
 struct Item
 {
-    const char* name; // unique id (e.g., "show")
-    ExampleFn* fn;    // function to run
-    const char* help; // short description
+    const char* name;              // unique id (e.g., "show")
+    ExampleFn* fn;                 // function to run (nullptr until a plugin is loaded)
+    const char* help;              // short description
+    const char* library = nullptr; // plugin path for manifest entries, nullptr if linked in
 };
 
+//! Symbol every plugin exports as its `int(int,char**)` entry point
+inline constexpr const char* kPluginEntry = "examples_plugin_main";
+
 //! Register a new example (used by the Registrar helper)
 void register_example(const Item& item);
 
@@ -35,6 +44,12 @@ const std::vector<Item>& all();
 //! Find an example by name (or nullptr if not found)
 const Item* find(std::string_view name);
 
+//! Register every `*.example` manifest in dir without loading its plugin. Returns count added.
+size_t load_manifests(const std::string& dir);
+
+//! Entry point of an example, dlopen-ing its plugin on first use. nullptr on failure (see error).
+ExampleFn* resolve(const Item& item, std::string* error = nullptr);
+
 //! Helper to register from any translation unit via static init
 struct Registrar
 {
@@ -43,9 +58,19 @@ struct Registrar
 
 } // namespace examples
 
-// Macro to register an example function with a given name and help string
+// Macro to register an example function with a given name and help string. Plugin builds export
+// the function as `examples_plugin_main`; name and help come from the generated manifest instead.
+#if defined(HELLOWORLD_PLUGIN)
+#define REGISTER_EXAMPLE(NAME, FN, HELP)                                                           \
+    extern "C" __attribute__((visibility("default"))) int examples_plugin_main(int argc,           \
+                                                                               char** argv)        \
+    {                                                                                              \
+        return FN(argc, argv);                                                                     \
+    }
+#else
 #define REGISTER_EXAMPLE(NAME, FN, HELP)                                                           \
     namespace                                                                                      \
     {                                                                                              \
     ::examples::Registrar _reg_##FN({NAME, FN, HELP});                                             \
     }
+#endif
@@ -0,0 +1,261 @@
+/**
+ * \file
+ * \ingroup examples
+ * Frame ring producer: publishes frames into a shared-memory ring (frame_ring.h) for other
+ * processes to consume without going through image files.
+ *
+ * The source is a camera index, a video, or a still image republished at `--fps`. Consumers
+ * read the ring with `shm:<name>` wherever an example takes an image path, e.g.
+ * `edges --deadline-ms 15 shm:/helloworld`. `--bench N` instead measures capture-to-Mat latency
+ * of the ring against the file path it replaces (encode, write, read, decode).
+ */
+#include "cli/argparse.h"
+#include "cv_util.h"
+#include "examples/registry.h"
+#include "frame_ring.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fmt/format.h>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using examples::ExampleFn;
+
+namespace
+{
+
+struct Latency
+{
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+Latency summarize(std::vector<double> us)
+{
+    Latency l;
+    if (us.empty())
+        return l;
+    std::sort(us.begin(), us.end());
+    for (double v : us)
+        l.mean += v;
+    l.mean /= static_cast<double>(us.size());
+    l.p50 = us[us.size() / 2];
+    l.p99 = us[std::min(us.size() - 1, us.size() * 99 / 100)];
+    l.max = us.back();
+    return l;
+}
+
+// Producer thread publishes every `interval`; the consumer measures from the producer's
+// timestamp (taken before the copy) to holding a usable Mat
+std::vector<double> bench_ring(const cv::Mat& img, int frames, std::chrono::microseconds interval,
+                               const std::string& name)
+{
+    frame_ring::Writer writer(name, 4, img.total() * img.elemSize());
+    frame_ring::Reader reader(name);
+    std::thread producer(
+        [&]
+        {
+            for (int i = 0; i < frames; ++i)
+            {
+                writer.write(img, true);
+                std::this_thread::sleep_for(interval);
+            }
+        });
+
+    std::vector<double> us;
+    frame_ring::Frame f;
+    for (int i = 0; i < frames && reader.acquire(f, 1000); ++i)
+        us.push_back((frame_ring::now_ns() - f.timestamp_ns) / 1e3);
+    reader.release();
+    producer.join();
+    return us;
+}
+
+// The path the ring replaces: encode + write (temp file + rename) on one side, read + decode
+// through cv_util::load on the other. The consumer is signalled in-process rather than polling
+// the directory, so these numbers are a lower bound for the file path.
+std::vector<double> bench_files(const cv::Mat& img, int frames, std::chrono::microseconds interval,
+                                const std::string& ext)
+{
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / fmt::format("ringfeed-{}", ::getpid());
+    fs::create_directories(dir);
+
+    std::vector<int64_t> stamps(static_cast<size_t>(frames));
+    std::atomic<int> published{0};
+    std::thread producer(
+        [&]
+        {
+            for (int i = 0; i < frames; ++i)
+            {
+                stamps[i] = frame_ring::now_ns();
+                const fs::path out = dir / fmt::format("frame_{:06d}{}", i, ext);
+                const fs::path tmp = dir / fmt::format(".tmp{}", ext);
+                cv::imwrite(tmp.string(), img);
+                fs::rename(tmp, out);
+                published.store(i + 1, std::memory_order_release);
+                std::this_thread::sleep_for(interval);
+            }
+        });
+
+    std::vector<double> us;
+    for (int i = 0; i < frames; ++i)
+    {
+        for (int spins = 0; published.load(std::memory_order_acquire) <= i; ++spins)
+            std::this_thread::yield();
+        const fs::path in = dir / fmt::format("frame_{:06d}{}", i, ext);
+        cv_util::load(in.string());
+        us.push_back((frame_ring::now_ns() - stamps[i]) / 1e3);
+        fs::remove(in);
+    }
+    producer.join();
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    return us;
+}
+
+int run_bench(const cv::Mat& img, int frames, double fps, const std::string& name,
+              logger::Logger& log)
+{
+    const auto interval = std::chrono::microseconds(static_cast<int64_t>(1e6 / fps));
+    log.info("bench: {} frames of {}x{} ({:.1f} MiB) at {:.0f} fps", frames, img.cols, img.rows,
+             img.total() * img.elemSize() / (1024.0 * 1024.0), fps);
+
+    const auto report = [&](const char* what, const Latency& l)
+    {
+        log.info("{:<10} mean {:9.1f} us  p50 {:9.1f} us  p99 {:9.1f} us  max {:9.1f} us", what,
+                 l.mean, l.p50, l.p99, l.max);
+    };
+    const Latency ring = summarize(bench_ring(img, frames, interval, name));
+    report("shm ring", ring);
+    for (const std::string ext : {".png", ".bmp"})
+    {
+        const Latency files = summarize(bench_files(img, frames, interval, ext));
+        report(ext.c_str(), files);
+        log.info("{:<10} ring is x{:.1f} faster (mean)", "",
+                 files.mean / std::max(ring.mean, 1e-3));
+    }
+    return 0;
+}
+
+} // namespace
+
+static int ringfeed_example(int argc, char** argv)
+{
+    logger::Logger log{"ringfeed", logger::Level::INFO};
+
+    cli::ArgParser ap{"ringfeed"};
+    ap.add_option("ring", 'r', "Shared-memory ring name", "/helloworld");
+    ap.add_option("slots", 's', "Frames in the ring", "4");
+    ap.add_option("fps", 'F', "Publish rate for still images and the benchmark", "30");
+    ap.add_option("frames", 'n', "Frames to publish (0 = until the source ends; a still image is "
+                                 "published 300 times)",
+                  "0");
+    ap.add_flag("block", 'k', "Wait for the consumer when the ring is full instead of dropping");
+    ap.add_option("bench", 'B', "Benchmark: compare N frames through the ring and through files "
+                                "(0 = off)",
+                  "0");
+    ap.add_positional("path", "Camera index, video or image (default: assets/lena_img.png)");
+    if (!ap.parse(argc, argv) || ap.help())
+    {
+        log.info("\n{}", ap.usage());
+        return ap.help() ? 0 : 2;
+    }
+    const std::string name = ap.get_string("ring", "/helloworld");
+    const double fps = std::max(0.1, ap.get_double("fps", 30.0));
+    const bool block = ap.get_flag("block");
+    int frames = std::max(0, ap.get_int("frames", 0));
+    std::string source =
+        ap.positionals().empty() ? std::string{"assets/lena_img.png"} : ap.positionals().front();
+
+    cv::VideoCapture cap;
+    cv::Mat still;
+    if (!cv_util::isCameraIndex(source) && cv::haveImageReader(source))
+    {
+        try
+        {
+            still = cv_util::load(source);
+        }
+        catch (const std::exception& e)
+        {
+            log.error("{}", e.what());
+            return 1;
+        }
+    }
+    else if (cv_util::isCameraIndex(source) ? !cap.open(std::stoi(source)) : !cap.open(source))
+    {
+        log.error("cannot open video source {}", source);
+        return 1;
+    }
+
+    if (const int n = ap.get_int("bench", 0); n > 0)
+    {
+        cv::Mat img = still;
+        if (img.empty() && !cap.read(img))
+        {
+            log.error("no frames read from {}", source);
+            return 1;
+        }
+        try
+        {
+            return run_bench(img, n, fps, name + "-bench", log);
+        }
+        catch (const std::exception& e)
+        {
+            log.error("{}", e.what());
+            return 1;
+        }
+    }
+
+    // The ring is sized for the first frame; later frames must not be larger
+    cv::Mat frame = still;
+    if (frame.empty() && !cap.read(frame))
+    {
+        log.error("no frames read from {}", source);
+        return 1;
+    }
+    if (!still.empty() && frames == 0)
+        frames = 300;
+
+    try
+    {
+        frame_ring::Writer writer(name, static_cast<uint32_t>(std::max(1, ap.get_int("slots", 4))),
+                                  frame.total() * frame.elemSize());
+        log.info("publishing {} ({}x{}) to shm:{}{}", source, frame.cols, frame.rows, name,
+                 block ? " (blocking)" : "");
+        const auto interval = std::chrono::microseconds(static_cast<int64_t>(1e6 / fps));
+        auto next = std::chrono::steady_clock::now();
+        for (int i = 0; frames == 0 || i < frames; ++i)
+        {
+            if (i > 0 && still.empty() && (!cap.read(frame) || frame.empty()))
+                break;
+            writer.write(frame, block);
+            // Cameras and videos pace themselves; a still image is paced to --fps
+            if (!still.empty())
+            {
+                next += interval;
+                std::this_thread::sleep_until(next);
+            }
+        }
+        log.info("published {} frame(s), dropped {} (consumer too slow)", writer.written(),
+                 writer.dropped());
+    }
+    catch (const std::exception& e)
+    {
+        log.error("{}", e.what());
+        return 1;
+    }
+    return 0;
+}
+
+REGISTER_EXAMPLE("ringfeed", ringfeed_example, "Publish frames to a shared-memory frame ring");
@@ -0,0 +1,169 @@
+/**
+ * \file
+ * \ingroup examples
+ * Outer/inner thread split benchmark on the edges pipeline (blur, gray, Canny).
+ *
+ * Each configuration `OUTER:INNER` runs OUTER worker threads (sched::run_workers, placed per the
+ * runner's `--placement`/`--topology`) pulling frames from a shared counter, with OpenCV itself
+ * limited to INNER threads. Workers allocate their buffers once, on their own thread, so with
+ * NUMA placement the per-frame working set stays on the worker's node. Without `--configs` the
+ * benchmark compares outer-only (N:1), inner-only (1:N) and mixed splits of the CPUs in the
+ * topology.
+ */
+#include "cli/argparse.h"
+#include "cv_util.h"
+#include "examples/registry.h"
+#include "logger.h"
+#include "scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <opencv2/imgproc.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using examples::ExampleFn;
+
+namespace
+{
+
+struct Split
+{
+    int outer = 1;
+    int inner = 1;
+};
+
+// "8:1,1:8,4:2"; malformed entries are skipped
+std::vector<Split> parse_splits(const std::string& s)
+{
+    std::vector<Split> out;
+    std::stringstream ss(s);
+    for (std::string part; std::getline(ss, part, ',');)
+    {
+        Split sp;
+        if (sched::parse_threads(part, sp.outer, sp.inner))
+            out.push_back(sp);
+    }
+    return out;
+}
+
+// Outer-only, inner-only and the balanced mixed splits of `cpus`
+std::vector<Split> default_splits(int cpus)
+{
+    std::vector<Split> out{{cpus, 1}, {1, cpus}};
+    for (int outer = 2; outer < cpus; outer *= 2)
+    {
+        if (cpus % outer == 0)
+            out.push_back({outer, cpus / outer});
+    }
+    return out;
+}
+
+struct Result
+{
+    double seconds = 0.0;
+    double fps = 0.0;
+};
+
+Result run_split(const cv::Mat& frame, const Split& sp, int frames, int blur)
+{
+    sched::Config cfg = sched::config();
+    cfg.outer = sp.outer;
+    cfg.inner = sp.inner;
+    sched::configure(cfg);
+
+    std::atomic<int> next{0};
+    const auto t0 = std::chrono::steady_clock::now();
+    sched::run_workers(
+        [&](int)
+        {
+            // Worker-local buffers: first touched (and reused) on this worker's CPUs
+            cv::Mat blurred(frame.size(), frame.type());
+            cv::Mat gray(frame.size(), CV_8UC1);
+            cv::Mat edges(frame.size(), CV_8UC1);
+            while (next.fetch_add(1, std::memory_order_relaxed) < frames)
+            {
+                cv::GaussianBlur(frame, blurred, cv::Size(blur, blur), 0);
+                cv::cvtColor(blurred, gray, cv::COLOR_BGR2GRAY);
+                cv::Canny(gray, edges, 100, 200);
+            }
+        });
+    const std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+
+    Result r;
+    r.seconds = dt.count();
+    r.fps = frames / dt.count();
+    return r;
+}
+
+} // namespace
+
+static int sched_bench_example(int argc, char** argv)
+{
+    logger::Logger log{"schedbench", logger::Level::INFO};
+
+    cli::ArgParser ap{"schedbench"};
+    ap.add_option("configs", 'c', "Comma-separated OUTER:INNER splits (default: outer-only, "
+                                  "inner-only and mixed splits of all CPUs)");
+    ap.add_option("frames", 'n', "Frames per configuration", "64");
+    ap.add_option("scale", 's', "Upscale factor applied to the input frame", "4");
+    ap.add_option("blur", 'b', "Gaussian blur kernel size (odd)", "5");
+    ap.add_positional("path", "Image path (default: assets/lena_img.png)");
+    if (!ap.parse(argc, argv) || ap.help())
+    {
+        log.info("\n{}", ap.usage());
+        return ap.help() ? 0 : 2;
+    }
+    const int frames = std::max(1, ap.get_int("frames", 64));
+    const double scale = std::max(0.1, ap.get_double("scale", 4.0));
+    const int blur = std::max(1, ap.get_int("blur", 5)) | 1;
+
+    std::string path =
+        ap.positionals().empty() ? std::string{"assets/lena_img.png"} : ap.positionals().front();
+    cv::Mat frame;
+    try
+    {
+        frame = cv_util::load(path);
+    }
+    catch (const std::exception& e)
+    {
+        log.error("{}", e.what());
+        return 1;
+    }
+    if (scale != 1.0)
+        cv::resize(frame, frame, cv::Size(), scale, scale, cv::INTER_LINEAR);
+
+    const sched::Config saved = sched::config();
+    std::vector<Split> splits = ap.get_string("configs").empty()
+                                    ? default_splits(saved.topology.cpus())
+                                    : parse_splits(ap.get_string("configs"));
+    if (splits.empty())
+    {
+        log.error("no valid --configs in '{}' (expected e.g. 8:1,1:8,4:2)",
+                  ap.get_string("configs"));
+        return 2;
+    }
+
+    log.info("{} frames of {}x{} per split, placement={} on {}", frames, frame.cols, frame.rows,
+             sched::to_string(saved.placement), saved.topology.describe());
+
+    // Warm up OpenCV's pool and the caches so the first split is not penalized
+    run_split(frame, {1, std::max(1, saved.topology.cpus())}, 2, blur);
+
+    const Result base = run_split(frame, splits.front(), frames, blur);
+    for (size_t i = 0; i < splits.size(); ++i)
+    {
+        const Result r = i == 0 ? base : run_split(frame, splits[i], frames, blur);
+        log.info("{:>3}:{:<3} {:8.1f} frames/s  {:7.3f} s  x{:.2f}", splits[i].outer,
+                 splits[i].inner, r.fps, r.seconds, r.fps / base.fps);
+    }
+
+    sched::configure(saved);
+    if (saved.inner == 0)
+        cv::setNumThreads(-1); // back to OpenCV's default pool size
+    return 0;
+}
+
+REGISTER_EXAMPLE("schedbench", sched_bench_example, "Benchmark outer/inner thread splits");
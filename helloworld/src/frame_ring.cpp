@@ -0,0 +1,310 @@
+#include "frame_ring.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace frame_ring
+{
+
+namespace
+{
+
+constexpr uint32_t kMagic = 0x48575246; // "HWRF"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kPage = 4096;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared counters must be lock-free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared counters must be lock-free");
+
+size_t round_up(size_t n, size_t to)
+{
+    return (n + to - 1) / to * to;
+}
+
+std::string shm_name(const std::string& name)
+{
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+std::runtime_error sys_error(const std::string& what, const std::string& name)
+{
+    return std::runtime_error("frame_ring: " + what + " " + name + ": " + std::strerror(errno));
+}
+
+// Spin briefly (frames usually arrive within microseconds under load), then yield, then sleep
+void backoff(int& spins)
+{
+    if (++spins < 64)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+}
+
+} // namespace
+
+// Per-frame metadata, written by the producer before write_seq publishes the slot
+struct SlotHeader
+{
+    int32_t rows;
+    int32_t cols;
+    int32_t type;
+    int32_t reserved;
+    uint64_t step;
+    uint64_t seq;
+    int64_t timestamp_ns;
+};
+
+// Start of the shared object; slot headers follow it, frame data starts at data_offset
+struct RingHeader
+{
+    std::atomic<uint32_t> magic; // set last by the writer: readers wait for a complete header
+    uint32_t version;
+    uint32_t slots;
+    uint32_t reserved;
+    uint64_t slot_bytes;
+    uint64_t data_offset;
+    // Producer and consumer counters on separate cache lines
+    alignas(64) std::atomic<uint64_t> write_seq;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint32_t> closed;
+    alignas(64) std::atomic<uint64_t> read_seq;
+
+    SlotHeader* slot(uint64_t seq)
+    {
+        return reinterpret_cast<SlotHeader*>(this + 1) + seq % slots;
+    }
+    uint8_t* data(uint64_t seq)
+    {
+        return reinterpret_cast<uint8_t*>(this) + data_offset + (seq % slots) * slot_bytes;
+    }
+};
+
+int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+Writer::Writer(const std::string& name, uint32_t slots, size_t slot_bytes) : name_(shm_name(name))
+{
+    if (slots == 0 || slot_bytes == 0)
+        throw std::runtime_error("frame_ring: empty ring " + name_);
+    slot_bytes = round_up(slot_bytes, kPage);
+    const size_t data_offset = round_up(sizeof(RingHeader) + slots * sizeof(SlotHeader), kPage);
+    size_ = data_offset + slots * slot_bytes;
+
+    // A stale ring from a crashed producer is replaced; readers still mapping it keep the old one
+    ::shm_unlink(name_.c_str());
+    const int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        throw sys_error("cannot create", name_);
+    if (::ftruncate(fd, static_cast<off_t>(size_)) != 0)
+    {
+        const auto err = sys_error("cannot size", name_);
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        throw err;
+    }
+    void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+    {
+        ::shm_unlink(name_.c_str());
+        throw sys_error("cannot map", name_);
+    }
+
+    // Fresh pages are zero; the atomics are valid as zero-initialized lock-free integers
+    header_ = static_cast<RingHeader*>(p);
+    header_->version = kVersion;
+    header_->slots = slots;
+    header_->slot_bytes = slot_bytes;
+    header_->data_offset = data_offset;
+    header_->magic.store(kMagic, std::memory_order_release);
+}
+
+Writer::~Writer()
+{
+    header_->closed.store(1, std::memory_order_release);
+    ::munmap(header_, size_);
+    ::shm_unlink(name_.c_str());
+}
+
+bool Writer::write(const cv::Mat& img, bool block, int64_t timestamp_ns)
+{
+    const size_t row_bytes = img.cols * img.elemSize();
+    if (img.empty() || row_bytes * img.rows > header_->slot_bytes)
+        throw std::runtime_error("frame_ring: frame does not fit a slot of " + name_);
+
+    // Only this process advances write_seq; read_seq is the consumer's
+    const uint64_t w = header_->write_seq.load(std::memory_order_relaxed);
+    for (int spins = 0; w - header_->read_seq.load(std::memory_order_acquire) >= header_->slots;)
+    {
+        if (!block)
+        {
+            header_->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        backoff(spins);
+    }
+
+    uint8_t* dst = header_->data(w);
+    if (img.isContinuous())
+        std::memcpy(dst, img.data, row_bytes * img.rows);
+    else
+        for (int r = 0; r < img.rows; ++r)
+            std::memcpy(dst + r * row_bytes, img.ptr(r), row_bytes);
+
+    SlotHeader* s = header_->slot(w);
+    s->rows = img.rows;
+    s->cols = img.cols;
+    s->type = img.type();
+    s->step = row_bytes;
+    s->seq = w;
+    s->timestamp_ns = timestamp_ns ? timestamp_ns : now_ns();
+    header_->write_seq.store(w + 1, std::memory_order_release);
+    return true;
+}
+
+uint64_t Writer::written() const
+{
+    return header_->write_seq.load(std::memory_order_relaxed);
+}
+
+uint64_t Writer::dropped() const
+{
+    return header_->dropped.load(std::memory_order_relaxed);
+}
+
+Reader::Reader(const std::string& name)
+{
+    const std::string shm = shm_name(name);
+    const int fd = ::shm_open(shm.c_str(), O_RDWR, 0);
+    if (fd < 0)
+        throw sys_error("cannot open", shm);
+    struct stat st = {};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(RingHeader))
+    {
+        ::close(fd);
+        throw std::runtime_error("frame_ring: not a frame ring: " + shm);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        throw sys_error("cannot map", shm);
+    header_ = static_cast<RingHeader*>(p);
+
+    // The writer sizes the object before it fills the header; give it a moment
+    for (int spins = 0; header_->magic.load(std::memory_order_acquire) != kMagic && spins < 1000;)
+        backoff(spins);
+    if (header_->magic.load(std::memory_order_acquire) != kMagic ||
+        header_->version != kVersion ||
+        header_->data_offset + header_->slots * header_->slot_bytes > size_)
+    {
+        ::munmap(header_, size_);
+        throw std::runtime_error("frame_ring: not a frame ring: " + shm);
+    }
+}
+
+Reader::~Reader()
+{
+    release();
+    ::munmap(header_, size_);
+}
+
+bool Reader::acquire(Frame& out, int timeout_ms, bool latest)
+{
+    release();
+    out.image.release();
+
+    uint64_t r = header_->read_seq.load(std::memory_order_relaxed);
+    uint64_t w = header_->write_seq.load(std::memory_order_acquire);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    for (int spins = 0; w <= r; w = header_->write_seq.load(std::memory_order_acquire))
+    {
+        if (header_->closed.load(std::memory_order_acquire))
+        {
+            // Frames published right before closing still count
+            w = header_->write_seq.load(std::memory_order_acquire);
+            if (w > r)
+                break;
+            return false;
+        }
+        if (timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline)
+            return false;
+        backoff(spins);
+    }
+
+    if (latest && w - r > 1)
+    {
+        skipped_ += w - 1 - r;
+        r = w - 1;
+        header_->read_seq.store(r, std::memory_order_release);
+    }
+
+    const SlotHeader* s = header_->slot(r);
+    out.image = cv::Mat(s->rows, s->cols, s->type, header_->data(r), s->step);
+    out.seq = s->seq;
+    out.timestamp_ns = s->timestamp_ns;
+    held_ = true;
+    return true;
+}
+
+void Reader::release()
+{
+    if (!held_)
+        return;
+    held_ = false;
+    header_->read_seq.fetch_add(1, std::memory_order_release);
+}
+
+cv::Mat load(const std::string& name, int flags, int timeout_ms)
+{
+    // One reader per ring for the life of the process; examples load one frame at a time
+    static std::mutex mu;
+    static std::map<std::string, std::unique_ptr<Reader>> readers;
+    std::lock_guard<std::mutex> lock(mu);
+    auto& reader = readers[name];
+    if (!reader)
+        reader = std::make_unique<Reader>(name);
+
+    Frame f;
+    if (!reader->acquire(f, timeout_ms))
+        throw std::runtime_error("frame_ring: no frame from " + name);
+    return as_imread(f.image, flags);
+}
+
+cv::Mat as_imread(const cv::Mat& frame, int flags)
+{
+    if (flags == cv::IMREAD_UNCHANGED)
+        return frame;
+
+    // Same result layout as cv::imread: 8-bit, and gray or BGR as requested
+    cv::Mat img = frame;
+    if (img.depth() == CV_16U)
+        img.convertTo(img, CV_8U, 1.0 / 256.0);
+    else if (img.depth() != CV_8U)
+        throw std::runtime_error("frame_ring: unsupported frame depth for imread layout");
+    const int ch = img.channels();
+    if (flags == cv::IMREAD_GRAYSCALE && ch > 1)
+        cv::cvtColor(img, img, ch == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    else if (flags != cv::IMREAD_GRAYSCALE && ch != 3)
+        cv::cvtColor(img, img, ch == 4 ? cv::COLOR_BGRA2BGR : cv::COLOR_GRAY2BGR);
+    return img;
+}
+
+} // namespace frame_ring
@@ -0,0 +1,101 @@
+/**
+ * \file
+ * Shared-memory frame ring: zero-copy image input from a separate capture process.
+ *
+ * A Writer creates a POSIX shared-memory object holding a header and `slots` fixed-size frame
+ * slots. Frames are published single-producer/single-consumer through two counters in the
+ * header: the writer fills slot `write_seq % slots` and then advances `write_seq`, the reader
+ * wraps slot `read_seq % slots` in a cv::Mat header (no copy) and advances `read_seq` when it is
+ * done with it. A slot is never rewritten while the reader holds it; when the ring is full the
+ * writer either drops the new frame (live capture) or waits.
+ *
+ * Examples read a ring through cv_util::load("shm:<name>"); edges' `--deadline-ms` live mode
+ * reads it frame by frame, skipping to the newest.
+ */
+#pragma once
+
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include <string>
+
+namespace frame_ring
+{
+
+struct RingHeader;
+
+// Nanoseconds on the monotonic clock shared by all processes (frame timestamps)
+int64_t now_ns();
+
+class Writer
+{
+  public:
+    // Create (or replace) ring `name` with `slots` frames of up to `slot_bytes` each. Throws
+    // std::runtime_error on failure.
+    Writer(const std::string& name, uint32_t slots, size_t slot_bytes);
+    ~Writer(); // marks the ring closed and unlinks it
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // Copy img into the next slot and publish it, stamped with timestamp_ns (default: now).
+    // When the reader is `slots` frames behind: drop the frame and return false, or with block
+    // set wait for a free slot. Throws if img does not fit a slot.
+    bool write(const cv::Mat& img, bool block = false, int64_t timestamp_ns = 0);
+
+    uint64_t written() const;
+    uint64_t dropped() const;
+
+  private:
+    std::string name_;
+    RingHeader* header_ = nullptr;
+    size_t size_ = 0;
+};
+
+struct Frame
+{
+    cv::Mat image;            // points into the shared slot; valid until release()/next acquire()
+    uint64_t seq = 0;         // producer frame number
+    int64_t timestamp_ns = 0; // producer timestamp (now_ns() clock)
+};
+
+class Reader
+{
+  public:
+    // Map an existing ring. Throws std::runtime_error if it does not exist or is not a ring.
+    explicit Reader(const std::string& name);
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    // Release the held frame (if any) and wait up to timeout_ms (-1 = forever) for the next one.
+    // With latest set, frames older than the newest published one are skipped. Returns false on
+    // timeout or once the writer closed the ring and every frame was read.
+    bool acquire(Frame& out, int timeout_ms = -1, bool latest = false);
+
+    // Hand the held slot back to the writer
+    void release();
+
+    uint64_t skipped() const
+    {
+        return skipped_;
+    }
+
+  private:
+    RingHeader* header_ = nullptr;
+    size_t size_ = 0;
+    bool held_ = false;
+    uint64_t skipped_ = 0;
+};
+
+// Next frame of ring `name` (a Reader kept open per name), converted like cv::imread: 8-bit
+// BGR for IMREAD_COLOR, 8-bit gray for IMREAD_GRAYSCALE, as published for IMREAD_UNCHANGED.
+// Unconverted frames alias shared memory until the next call for the same ring.
+// Throws std::runtime_error when no frame arrives within timeout_ms.
+cv::Mat load(const std::string& name, int flags, int timeout_ms = 5000);
+
+// The conversion load() applies: `frame` in cv::imread's layout for `flags` (a copy when it has
+// to convert, `frame` itself otherwise). Throws std::runtime_error for depths other than 8/16-bit.
+cv::Mat as_imread(const cv::Mat& frame, int flags);
+
+} // namespace frame_ring
@@ -0,0 +1,383 @@
+#include "prefetch.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#if defined(HELLOWORLD_HAVE_LIBURING)
+#include <liburing.h>
+#endif
+
+namespace prefetch
+{
+
+using Clock = std::chrono::steady_clock;
+
+// Shared bookkeeping: per-file slots, consumer position and queue-depth/stall accounting
+class Prefetcher::Impl
+{
+  public:
+    Impl(std::vector<std::string> paths, const Options& opts)
+        : window_(std::max<size_t>(1, opts.window)), slots_(paths.size())
+    {
+        for (size_t i = 0; i < paths.size(); ++i)
+            slots_[i].buf.path = std::move(paths[i]);
+    }
+    virtual ~Impl() = default;
+
+    virtual bool next(Buffer& out) = 0;
+    virtual const char* name() const = 0;
+
+    Stats stats() const
+    {
+        Stats s = stats_;
+        s.avg_depth = depth_samples_ ? static_cast<double>(depth_sum_) / depth_samples_ : 0.0;
+        s.backend = name();
+        return s;
+    }
+
+  protected:
+    struct Slot
+    {
+        Buffer buf;
+        bool ready = false;
+        int fd = -1;
+        size_t done = 0; // bytes read so far (io_uring partial reads)
+    };
+
+    void sample_depth(size_t in_flight)
+    {
+        stats_.max_depth = std::max(stats_.max_depth, in_flight);
+        depth_sum_ += in_flight;
+        ++depth_samples_;
+    }
+
+    void hand_out(Slot& slot, Buffer& out, Clock::time_point wait_start)
+    {
+        stats_.stall_ms +=
+            std::chrono::duration<double, std::milli>(Clock::now() - wait_start).count();
+        ++stats_.files;
+        stats_.bytes += slot.buf.bytes.size();
+        out = std::move(slot.buf);
+        slot.buf = {};
+    }
+
+    // Open the file and size its buffer; on failure the slot carries an error and no fd
+    static bool open_slot(Slot& slot)
+    {
+        slot.fd = ::open(slot.buf.path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st{};
+        if (slot.fd < 0 || ::fstat(slot.fd, &st) != 0)
+        {
+            fail_slot(slot, std::strerror(errno));
+            return false;
+        }
+        slot.buf.bytes.resize(static_cast<size_t>(st.st_size));
+        slot.done = 0;
+        return true;
+    }
+
+    static void fail_slot(Slot& slot, const char* what)
+    {
+        slot.buf.error = "prefetch: " + slot.buf.path + ": " + what;
+        slot.buf.bytes.clear();
+        close_slot(slot);
+    }
+
+    // Callers publish `ready` themselves (under their lock where one is needed)
+    static void close_slot(Slot& slot)
+    {
+        if (slot.fd >= 0)
+            ::close(slot.fd);
+        slot.fd = -1;
+    }
+
+    size_t window_;
+    std::vector<Slot> slots_;
+    size_t consumed_ = 0;    // files handed out
+    size_t next_submit_ = 0; // next file to start reading
+
+  private:
+    Stats stats_;
+    size_t depth_sum_ = 0;
+    size_t depth_samples_ = 0;
+};
+
+namespace
+{
+
+// Fallback: worker threads fadvise + pread whole files, never more than `window` ahead
+class ThreadImpl final : public Prefetcher::Impl
+{
+  public:
+    ThreadImpl(std::vector<std::string> paths, const Options& opts)
+        : Impl(std::move(paths), opts)
+    {
+        const size_t n = std::clamp<size_t>(opts.threads, 1, window_);
+        for (size_t i = 0; i < n; ++i)
+            workers_.emplace_back([this] { work(); });
+    }
+
+    ~ThreadImpl() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stop_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto& t : workers_)
+            t.join();
+    }
+
+    bool next(Buffer& out) override
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        if (consumed_ >= slots_.size())
+            return false;
+        sample_depth(in_flight_);
+        const auto t0 = Clock::now();
+        ready_cv_.wait(lock, [&] { return slots_[consumed_].ready; });
+        hand_out(slots_[consumed_++], out, t0);
+        lock.unlock();
+        work_cv_.notify_one();
+        return true;
+    }
+
+    const char* name() const override
+    {
+        return "threads";
+    }
+
+  private:
+    void work()
+    {
+        for (;;)
+        {
+            size_t idx = 0;
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                work_cv_.wait(lock,
+                              [&]
+                              {
+                                  return stop_ || next_submit_ >= slots_.size() ||
+                                         next_submit_ < consumed_ + window_;
+                              });
+                if (stop_ || next_submit_ >= slots_.size())
+                    return;
+                idx = next_submit_++;
+                ++in_flight_;
+            }
+
+            // Slot contents are only touched by this worker until `ready` is published
+            Slot& slot = slots_[idx];
+            if (open_slot(slot))
+            {
+                ::posix_fadvise(slot.fd, 0, 0, POSIX_FADV_WILLNEED);
+                read_all(slot);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                slot.ready = true;
+                --in_flight_;
+            }
+            ready_cv_.notify_all();
+        }
+    }
+
+    static void read_all(Slot& slot)
+    {
+        auto& bytes = slot.buf.bytes;
+        while (slot.done < bytes.size())
+        {
+            const ssize_t r = ::pread(slot.fd, bytes.data() + slot.done, bytes.size() - slot.done,
+                                      static_cast<off_t>(slot.done));
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0)
+            {
+                fail_slot(slot, r < 0 ? std::strerror(errno) : "unexpected end of file");
+                return;
+            }
+            slot.done += static_cast<size_t>(r);
+        }
+        close_slot(slot);
+    }
+
+    std::mutex mu_;
+    std::condition_variable work_cv_;
+    std::condition_variable ready_cv_;
+    std::vector<std::thread> workers_;
+    size_t in_flight_ = 0;
+    bool stop_ = false;
+};
+
+#if defined(HELLOWORLD_HAVE_LIBURING)
+
+// io_uring: the consumer thread keeps `window` reads queued and reaps completions while waiting
+class UringImpl final : public Prefetcher::Impl
+{
+  public:
+    UringImpl(std::vector<std::string> paths, const Options& opts) : Impl(std::move(paths), opts)
+    {
+        ok_ = io_uring_queue_init(static_cast<unsigned>(window_), &ring_, 0) == 0;
+    }
+
+    ~UringImpl() override
+    {
+        if (!ok_)
+            return;
+        // Drain outstanding reads before their buffers go away
+        while (in_flight_ > 0)
+            reap_one();
+        io_uring_queue_exit(&ring_);
+    }
+
+    bool ok() const
+    {
+        return ok_;
+    }
+
+    bool next(Buffer& out) override
+    {
+        if (consumed_ >= slots_.size())
+            return false;
+        top_up();
+        sample_depth(in_flight_);
+        const auto t0 = Clock::now();
+        while (!slots_[consumed_].ready)
+            reap_one();
+        hand_out(slots_[consumed_++], out, t0);
+        top_up();
+        return true;
+    }
+
+    const char* name() const override
+    {
+        return "io_uring";
+    }
+
+  private:
+    void top_up()
+    {
+        bool queued = false;
+        while (next_submit_ < slots_.size() && next_submit_ < consumed_ + window_)
+        {
+            const size_t idx = next_submit_++;
+            Slot& slot = slots_[idx];
+            if (!open_slot(slot) || slot.buf.bytes.empty())
+            {
+                close_slot(slot);
+                slot.ready = true;
+                continue;
+            }
+            queue_read(idx);
+            queued = true;
+        }
+        if (queued)
+            io_uring_submit(&ring_);
+    }
+
+    void queue_read(size_t idx)
+    {
+        Slot& slot = slots_[idx];
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+        // The length is 32-bit: larger files take several reads through the short-read path
+        const size_t len = std::min<size_t>(slot.buf.bytes.size() - slot.done, kMaxRead);
+        io_uring_prep_read(sqe, slot.fd, slot.buf.bytes.data() + slot.done,
+                           static_cast<unsigned>(len), static_cast<__u64>(slot.done));
+        io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(idx));
+        ++in_flight_;
+    }
+
+    void reap_one()
+    {
+        io_uring_cqe* cqe = nullptr;
+        const int rc = io_uring_wait_cqe(&ring_, &cqe);
+        if (rc == -EINTR)
+            return;
+        if (rc < 0)
+        {
+            // Ring is unusable; fail every read still outstanding so next() cannot hang
+            for (auto& slot : slots_)
+            {
+                if (!slot.ready && slot.fd >= 0)
+                {
+                    fail_slot(slot, std::strerror(-rc));
+                    slot.ready = true;
+                }
+            }
+            in_flight_ = 0;
+            return;
+        }
+        const auto idx = reinterpret_cast<size_t>(io_uring_cqe_get_data(cqe));
+        const int res = cqe->res;
+        io_uring_cqe_seen(&ring_, cqe);
+        --in_flight_;
+
+        Slot& slot = slots_[idx];
+        if (res <= 0)
+        {
+            fail_slot(slot, res < 0 ? std::strerror(-res) : "unexpected end of file");
+            slot.ready = true;
+            return;
+        }
+        slot.done += static_cast<size_t>(res);
+        if (slot.done < slot.buf.bytes.size())
+        {
+            // Short read: queue the remainder
+            queue_read(idx);
+            io_uring_submit(&ring_);
+            return;
+        }
+        close_slot(slot);
+        slot.ready = true;
+    }
+
+    static constexpr size_t kMaxRead = size_t{1} << 30; // per-request cap, below the 32-bit length
+
+    io_uring ring_{};
+    bool ok_ = false;
+    size_t in_flight_ = 0;
+};
+
+#endif
+
+} // namespace
+
+Prefetcher::Prefetcher(std::vector<std::string> paths, Options opts)
+{
+#if defined(HELLOWORLD_HAVE_LIBURING)
+    if (opts.backend != Backend::Threads)
+    {
+        auto uring = std::make_unique<UringImpl>(paths, opts);
+        if (uring->ok())
+        {
+            impl_ = std::move(uring);
+            return;
+        }
+    }
+#endif
+    impl_ = std::make_unique<ThreadImpl>(std::move(paths), opts);
+}
+
+Prefetcher::~Prefetcher() = default;
+
+bool Prefetcher::next(Buffer& out)
+{
+    return impl_->next(out);
+}
+
+Stats Prefetcher::stats() const
+{
+    return impl_->stats();
+}
+
+} // namespace prefetch
@@ -0,0 +1,71 @@
+/**
+ * \file
+ * Read-ahead of encoded image files for batch runs.
+ *
+ * A Prefetcher keeps up to `window` files of a path list in flight and hands their bytes out in
+ * input order, so decoding the current image overlaps with reading the next ones. Reads go
+ * through io_uring when the build found liburing and the kernel allows it, otherwise through a
+ * small pool of threads doing `posix_fadvise(WILLNEED)` + `pread`.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace prefetch
+{
+
+enum class Backend
+{
+    Auto,   // io_uring if built with liburing and the kernel allows it, else Threads
+    Threads // always the pread thread pool
+};
+
+struct Options
+{
+    size_t window = 8;  // files in flight ahead of the consumer
+    size_t threads = 4; // worker threads for the Threads backend
+    Backend backend = Backend::Auto;
+};
+
+// One file's encoded bytes. cv_util::decode wraps `bytes` in place, without a copy.
+struct Buffer
+{
+    std::string path;
+    std::vector<uint8_t> bytes;
+    std::string error; // empty on success
+};
+
+struct Stats
+{
+    size_t files = 0;
+    size_t bytes = 0;
+    double stall_ms = 0.0;   // time next() spent waiting for data
+    size_t max_depth = 0;    // most reads in flight observed by next()
+    double avg_depth = 0.0;  // mean reads in flight observed by next()
+    const char* backend = "";
+};
+
+class Prefetcher
+{
+  public:
+    Prefetcher(std::vector<std::string> paths, Options opts = {});
+    ~Prefetcher();
+
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+
+    // Next file in input order; blocks until it is read. Returns false once all were handed out.
+    bool next(Buffer& out);
+
+    Stats stats() const;
+
+    class Impl;
+
+  private:
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace prefetch
@@ -0,0 +1,402 @@
+#include "result_cache.h"
+
+#include "code_version.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace result_cache
+{
+
+namespace
+{
+
+constexpr char kMagic[4] = {'H', 'W', 'R', 'C'};
+constexpr uint32_t kFormat = 1;
+constexpr uint64_t kK0 = 0xa0761d6478bd642fULL;
+constexpr uint64_t kK1 = 0xe7037ed1a0b428dbULL;
+constexpr uint64_t kK2 = 0x8ebc6af09c88c6e3ULL;
+constexpr uint64_t kK3 = 0x589965cc75374cc3ULL;
+
+struct State
+{
+    std::mutex mu;
+    fs::path dir;
+    uint64_t max_bytes = 0;
+    bool on = false;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+State& state()
+{
+    static State s;
+    return s;
+}
+
+uint64_t mix(uint64_t a, uint64_t b)
+{
+    const __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
+
+uint64_t load64(const unsigned char* p)
+{
+    uint64_t v = 0;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+bool read_file(const fs::path& path, std::string& out)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+// Write via a unique temp file in the same directory + rename, so readers see all or nothing
+bool write_atomic(const fs::path& path, const std::string& bytes)
+{
+    static std::atomic<unsigned> counter{0};
+    const fs::path dir = path.has_parent_path() ? path.parent_path() : fs::path{"."};
+    const fs::path tmp = dir / (".tmp-" + std::to_string(::getpid()) + "-" +
+                                std::to_string(counter++) + "-" + path.filename().string());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out)
+        {
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec)
+    {
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+// Hit/miss totals live in `<dir>/stats`, updated under flock so parallel runs add up
+bool read_totals(int fd, unsigned long long& hits, unsigned long long& misses)
+{
+    char buf[64] = {};
+    hits = 0;
+    misses = 0;
+    const ssize_t n = ::pread(fd, buf, sizeof(buf) - 1, 0);
+    return n > 0 && std::sscanf(buf, "%llu %llu", &hits, &misses) == 2;
+}
+
+void bump_totals(const fs::path& dir, bool hit)
+{
+    const int fd = ::open((dir / "stats").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return;
+    ::flock(fd, LOCK_EX);
+    unsigned long long h = 0;
+    unsigned long long m = 0;
+    read_totals(fd, h, m);
+    (hit ? h : m) += 1;
+    char buf[64];
+    const int len = std::snprintf(buf, sizeof(buf), "%llu %llu\n", h, m);
+    if (::ftruncate(fd, 0) == 0 && len > 0)
+        (void)::pwrite(fd, buf, static_cast<size_t>(len), 0);
+    ::close(fd); // releases the lock
+}
+
+void count(State& st, bool hit)
+{
+    (hit ? st.hits : st.misses) += 1;
+    bump_totals(st.dir, hit);
+}
+
+// Drop least recently used entries until the directory fits the cap; also sweep temp files
+// left behind by crashed runs
+void evict(const State& st)
+{
+    struct Entry
+    {
+        fs::path path;
+        fs::file_time_type mtime;
+        uint64_t size;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    const auto stale = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    for (const auto& de : fs::directory_iterator(st.dir, ec))
+    {
+        const auto name = de.path().filename().string();
+        const auto mtime = de.last_write_time(ec);
+        if (ec)
+            continue;
+        if (name.rfind(".tmp-", 0) == 0)
+        {
+            if (mtime < stale)
+                fs::remove(de.path(), ec);
+            continue;
+        }
+        if (de.path().extension() != ".entry")
+            continue;
+        const auto size = de.file_size(ec);
+        if (ec)
+            continue;
+        entries.push_back({de.path(), mtime, size});
+        total += size;
+    }
+    if (total <= st.max_bytes)
+        return;
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.mtime < b.mtime; });
+    for (const auto& e : entries)
+    {
+        if (total <= st.max_bytes)
+            break;
+        // Another run may have removed it already; either way it no longer counts
+        fs::remove(e.path, ec);
+        total -= e.size;
+    }
+}
+
+} // namespace
+
+std::string Key::hex() const
+{
+    char buf[33];
+    std::snprintf(buf, sizeof(buf), "%016llx%016llx", static_cast<unsigned long long>(hi),
+                  static_cast<unsigned long long>(lo));
+    return buf;
+}
+
+void Hasher::block(const unsigned char* p, uint64_t& s0, uint64_t& s1)
+{
+    const uint64_t a = load64(p);
+    const uint64_t b = load64(p + 8);
+    s0 = mix(a ^ s0 ^ kK0, b ^ kK1);
+    s1 = mix(b ^ s1 ^ kK2, a ^ kK3);
+}
+
+void Hasher::update(const void* data, size_t size)
+{
+    const auto* p = static_cast<const unsigned char*>(data);
+    total_ += size;
+    if (tail_size_ > 0)
+    {
+        const size_t take = std::min(sizeof(tail_) - tail_size_, size);
+        std::memcpy(tail_ + tail_size_, p, take);
+        tail_size_ += take;
+        p += take;
+        size -= take;
+        if (tail_size_ < sizeof(tail_))
+            return;
+        block(tail_, s0_, s1_);
+        tail_size_ = 0;
+    }
+    for (; size >= 16; p += 16, size -= 16)
+        block(p, s0_, s1_);
+    if (size > 0)
+        std::memcpy(tail_, p, size);
+    tail_size_ = size;
+}
+
+void Hasher::add(std::string_view field)
+{
+    const uint64_t n = field.size();
+    update(&n, sizeof(n));
+    update(field.data(), field.size());
+}
+
+Key Hasher::digest() const
+{
+    uint64_t s0 = s0_;
+    uint64_t s1 = s1_;
+    if (tail_size_ > 0)
+    {
+        unsigned char last[16] = {};
+        std::memcpy(last, tail_, tail_size_);
+        block(last, s0, s1);
+    }
+    Key k;
+    k.hi = mix(s0 ^ total_ ^ kK2, s1 ^ kK1);
+    k.lo = mix(s1 ^ (total_ << 32 | total_ >> 32) ^ kK0, s0 ^ kK3 ^ k.hi);
+    return k;
+}
+
+bool enable(const std::string& dir, uint64_t max_bytes)
+{
+    auto& st = state();
+    std::lock_guard<std::mutex> lock(st.mu);
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (!fs::is_directory(dir, ec))
+        return false;
+    st.dir = dir;
+    st.max_bytes = max_bytes;
+    st.on = true;
+    return true;
+}
+
+bool enabled()
+{
+    auto& st = state();
+    std::lock_guard<std::mutex> lock(st.mu);
+    return st.on;
+}
+
+Key make_key(std::string_view example, std::string_view version, std::string_view options,
+             const void* data, size_t size)
+{
+    Hasher h;
+    h.add(HELLOWORLD_CODE_VERSION);
+    h.add(example);
+    h.add(version);
+    h.add(options);
+    h.update(data, size);
+    return h.digest();
+}
+
+std::optional<Key> make_key_for_file(std::string_view example, std::string_view version,
+                                     std::string_view options, const std::string& path)
+{
+    if (!enabled())
+        return std::nullopt;
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return std::nullopt;
+
+    Hasher h;
+    h.add(HELLOWORLD_CODE_VERSION);
+    h.add(example);
+    h.add(version);
+    h.add(options);
+    std::vector<char> chunk(1 << 20);
+    while (in)
+    {
+        in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        h.update(chunk.data(), static_cast<size_t>(in.gcount()));
+    }
+    if (in.bad())
+        return std::nullopt;
+    return h.digest();
+}
+
+bool restore(const Key& key, const std::vector<std::string>& outputs)
+{
+    auto& st = state();
+    std::lock_guard<std::mutex> lock(st.mu);
+    if (!st.on)
+        return false;
+
+    const fs::path entry = st.dir / (key.hex() + ".entry");
+    std::string blob;
+    bool ok = read_file(entry, blob) && blob.size() >= 12 &&
+              std::memcmp(blob.data(), kMagic, sizeof(kMagic)) == 0;
+    uint32_t format = 0;
+    uint32_t n = 0;
+    if (ok)
+    {
+        std::memcpy(&format, blob.data() + 4, sizeof(format));
+        std::memcpy(&n, blob.data() + 8, sizeof(n));
+        ok = format == kFormat && n == outputs.size();
+    }
+
+    size_t off = 12;
+    for (size_t i = 0; ok && i < outputs.size(); ++i)
+    {
+        uint64_t size = 0;
+        if (blob.size() - off < sizeof(size))
+        {
+            ok = false;
+            break;
+        }
+        std::memcpy(&size, blob.data() + off, sizeof(size));
+        off += sizeof(size);
+        if (blob.size() - off < size)
+        {
+            ok = false;
+            break;
+        }
+        ok = write_atomic(outputs[i], blob.substr(off, size));
+        off += size;
+    }
+
+    if (ok)
+    {
+        // Refresh mtime: eviction is least-recently-used
+        std::error_code ec;
+        fs::last_write_time(entry, fs::file_time_type::clock::now(), ec);
+    }
+    count(st, ok);
+    return ok;
+}
+
+bool store(const Key& key, const std::vector<std::string>& outputs)
+{
+    auto& st = state();
+    std::lock_guard<std::mutex> lock(st.mu);
+    if (!st.on)
+        return false;
+
+    std::string blob(kMagic, sizeof(kMagic));
+    const uint32_t n = static_cast<uint32_t>(outputs.size());
+    blob.append(reinterpret_cast<const char*>(&kFormat), sizeof(kFormat));
+    blob.append(reinterpret_cast<const char*>(&n), sizeof(n));
+    std::string bytes;
+    for (const auto& out : outputs)
+    {
+        if (!read_file(out, bytes))
+            return false;
+        const uint64_t size = bytes.size();
+        blob.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        blob += bytes;
+    }
+    if (!write_atomic(st.dir / (key.hex() + ".entry"), blob))
+        return false;
+    evict(st);
+    return true;
+}
+
+Stats stats()
+{
+    auto& st = state();
+    std::lock_guard<std::mutex> lock(st.mu);
+    Stats s;
+    s.hits = st.hits;
+    s.misses = st.misses;
+    if (st.on)
+    {
+        const int fd = ::open((st.dir / "stats").c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0)
+        {
+            ::flock(fd, LOCK_SH);
+            unsigned long long h = 0;
+            unsigned long long m = 0;
+            read_totals(fd, h, m);
+            ::close(fd);
+            s.total_hits = h;
+            s.total_misses = m;
+        }
+    }
+    return s;
+}
+
+} // namespace result_cache
@@ -0,0 +1,83 @@
+/**
+ * \file
+ * \ingroup engine
+ * On-disk memoization of example outputs.
+ *
+ * The runner enables the cache (`--cache <dir>`); examples then build a Key from their name, a
+ * per-example version tag, an options string of the effective parameters that shape the output
+ * (e.g. edges' cache_options) and the raw input bytes, and call restore() before decoding
+ * anything. On a miss they compute as usual and store() the files they
+ * wrote. Entries are written to a temp file and renamed into place, so concurrent runs never see
+ * partial entries; the directory is kept under a byte cap by evicting least recently used
+ * entries.
+ */
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace result_cache
+{
+
+struct Key
+{
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    std::string hex() const;
+};
+
+// Streaming 128-bit non-cryptographic hash (two multiply-mix lanes over 16-byte blocks)
+class Hasher
+{
+  public:
+    void update(const void* data, size_t size);
+    // Length-prefixed, so ("ab","c") and ("a","bc") differ
+    void add(std::string_view field);
+    Key digest() const;
+
+  private:
+    static void block(const unsigned char* p, uint64_t& s0, uint64_t& s1);
+
+    uint64_t s0_ = 0x243f6a8885a308d3ULL;
+    uint64_t s1_ = 0x13198a2e03707344ULL;
+    uint64_t total_ = 0;
+    unsigned char tail_[16] = {};
+    size_t tail_size_ = 0;
+};
+
+struct Stats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t total_hits = 0;   // across all runs sharing the directory
+    uint64_t total_misses = 0; // across all runs sharing the directory
+};
+
+// Enable caching in dir (created if needed) capped at max_bytes. Returns false if unusable.
+bool enable(const std::string& dir, uint64_t max_bytes);
+
+// True once enable() succeeded in this process
+bool enabled();
+
+// Key over example name, version tag, build version, options and the input bytes
+Key make_key(std::string_view example, std::string_view version, std::string_view options,
+             const void* data, size_t size);
+
+// Same as make_key but hashing a file's contents; nullopt if the cache is off or unreadable
+std::optional<Key> make_key_for_file(std::string_view example, std::string_view version,
+                                     std::string_view options, const std::string& path);
+
+// On a hit, write the stored outputs to `outputs` (same order as stored) and return true
+bool restore(const Key& key, const std::vector<std::string>& outputs);
+
+// Store the current contents of `outputs` under key; evicts old entries beyond the cap
+bool store(const Key& key, const std::vector<std::string>& outputs);
+
+// This process' hits/misses plus the totals persisted in the cache directory
+Stats stats();
+
+} // namespace result_cache
@@ -0,0 +1,343 @@
+#include "scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace sched
+{
+
+namespace
+{
+
+Config& current()
+{
+    static Config cfg;
+    return cfg;
+}
+
+std::atomic<uint64_t> g_worker_runs{0};
+
+InnerThreadsHook& inner_hook()
+{
+    static InnerThreadsHook hook = nullptr;
+    return hook;
+}
+
+// "0-3,8-11" -> {0,1,2,3,8,9,10,11}
+std::vector<int> parse_cpulist(const std::string& s)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(s);
+    for (std::string part; std::getline(ss, part, ',');)
+    {
+        int a = 0;
+        int b = 0;
+        const int n = std::sscanf(part.c_str(), "%d-%d", &a, &b);
+        if (n == 1)
+            cpus.push_back(a);
+        else if (n == 2)
+            for (int c = a; c <= b; ++c)
+                cpus.push_back(c);
+    }
+    return cpus;
+}
+
+std::vector<int> allowed_cpus()
+{
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int c = 0; c < CPU_SETSIZE; ++c)
+            if (CPU_ISSET(c, &set))
+                cpus.push_back(c);
+    }
+#endif
+    if (cpus.empty())
+    {
+        const int n = static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+        for (int c = 0; c < n; ++c)
+            cpus.push_back(c);
+    }
+    return cpus;
+}
+
+void pin_current_thread(const std::vector<int>& cpus)
+{
+#if defined(__linux__)
+    if (cpus.empty())
+        return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus)
+        CPU_SET(c, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpus;
+#endif
+}
+
+// Prefer memory from `node` for this thread's future allocations (set_mempolicy without
+// depending on libnuma). Best effort: ignored where unsupported.
+void prefer_node(int node)
+{
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+    constexpr int kMpolPreferred = 1;
+    if (node < 0 || node >= 64)
+        return;
+    const unsigned long mask = 1UL << node;
+    syscall(SYS_set_mempolicy, kMpolPreferred, &mask, sizeof(mask) * 8);
+#else
+    (void)node;
+#endif
+}
+
+} // namespace
+
+int Topology::cpus() const
+{
+    size_t n = 0;
+    for (const auto& node : nodes)
+        n += node.size();
+    return static_cast<int>(n);
+}
+
+std::string Topology::describe() const
+{
+    std::ostringstream os;
+    os << nodes.size() << " node(s) x " << (nodes.empty() ? 0 : nodes[0].size()) << " cpu(s)"
+       << (simulated ? " [simulated]" : "");
+    return os.str();
+}
+
+Topology Topology::detect()
+{
+    namespace fs = std::filesystem;
+    const auto allowed = allowed_cpus();
+
+    // Node directories may be sparse (node0, node2, ...)
+    std::vector<int> ids;
+    std::error_code ec;
+    for (const auto& de : fs::directory_iterator("/sys/devices/system/node", ec))
+    {
+        int id = 0;
+        const auto name = de.path().filename().string();
+        if (std::sscanf(name.c_str(), "node%d", &id) == 1)
+            ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+
+    Topology t;
+    for (int id : ids)
+    {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+        std::string line;
+        std::getline(in, line);
+        std::vector<int> cpus;
+        for (int c : parse_cpulist(line))
+            if (std::find(allowed.begin(), allowed.end(), c) != allowed.end())
+                cpus.push_back(c);
+        if (!cpus.empty())
+        {
+            t.nodes.push_back(std::move(cpus));
+            t.node_ids.push_back(id);
+        }
+    }
+    if (t.nodes.empty())
+    {
+        t.nodes.push_back(allowed);
+        t.node_ids.push_back(0);
+    }
+    return t;
+}
+
+Topology Topology::simulate(int nodes, int cpus_per_node)
+{
+    const auto real = allowed_cpus();
+    Topology t;
+    t.simulated = true;
+    for (int n = 0; n < nodes; ++n)
+    {
+        std::vector<int> cpus;
+        for (int c = 0; c < cpus_per_node; ++c)
+            cpus.push_back(real[static_cast<size_t>(n * cpus_per_node + c) % real.size()]);
+        t.nodes.push_back(std::move(cpus));
+        t.node_ids.push_back(n);
+    }
+    return t;
+}
+
+bool parse_threads(const std::string& s, int& outer, int& inner)
+{
+    int o = 0;
+    int i = 0;
+    if (std::sscanf(s.c_str(), "%d:%d", &o, &i) != 2 || o < 1 || i < 0)
+        return false;
+    outer = o;
+    inner = i;
+    return true;
+}
+
+bool parse_placement(const std::string& s, Placement& out)
+{
+    for (auto p : {Placement::None, Placement::Compact, Placement::Scatter, Placement::Numa})
+    {
+        if (s == to_string(p))
+        {
+            out = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_topology(const std::string& s, Topology& out)
+{
+    int nodes = 0;
+    int cpus = 0;
+    if (std::sscanf(s.c_str(), "%dx%d", &nodes, &cpus) != 2 || nodes < 1 || cpus < 1)
+        return false;
+    out = Topology::simulate(nodes, cpus);
+    return true;
+}
+
+const char* to_string(Placement p)
+{
+    switch (p)
+    {
+    case Placement::None:
+        return "none";
+    case Placement::Compact:
+        return "compact";
+    case Placement::Scatter:
+        return "scatter";
+    case Placement::Numa:
+        return "numa";
+    }
+    return "?";
+}
+
+void configure(const Config& cfg)
+{
+    Config& c = current();
+    c = cfg;
+    c.outer = std::max(1, c.outer);
+    if (c.topology.nodes.empty())
+        c.topology = Topology::detect();
+    if (c.inner > 0 && inner_hook())
+        inner_hook()(c.inner);
+}
+
+bool set_inner_threads_hook(InnerThreadsHook hook)
+{
+    inner_hook() = hook;
+    if (hook && current().inner > 0)
+        hook(current().inner);
+    return true;
+}
+
+const Config& config()
+{
+    Config& c = current();
+    if (c.topology.nodes.empty())
+        c.topology = Topology::detect();
+    return c;
+}
+
+int node_for(int worker)
+{
+    const Config& c = config();
+    const int nodes = static_cast<int>(c.topology.nodes.size());
+    switch (c.placement)
+    {
+    case Placement::None:
+        return -1;
+    case Placement::Compact:
+    {
+        int cpu = worker % std::max(1, c.topology.cpus());
+        for (int n = 0; n < nodes; ++n)
+        {
+            const int size = static_cast<int>(c.topology.nodes[n].size());
+            if (cpu < size)
+                return n;
+            cpu -= size;
+        }
+        return 0;
+    }
+    case Placement::Scatter:
+    case Placement::Numa:
+        return worker % nodes;
+    }
+    return -1;
+}
+
+std::vector<int> cpus_for(int worker)
+{
+    const Config& c = config();
+    const int node = node_for(worker);
+    if (node < 0)
+        return {};
+    const auto& cpus = c.topology.nodes[node];
+    switch (c.placement)
+    {
+    case Placement::Compact:
+    {
+        int cpu = worker % std::max(1, c.topology.cpus());
+        for (int n = 0; n < node; ++n)
+            cpu -= static_cast<int>(c.topology.nodes[n].size());
+        return {cpus[cpu]};
+    }
+    case Placement::Scatter:
+    {
+        const int nodes = static_cast<int>(c.topology.nodes.size());
+        return {cpus[static_cast<size_t>(worker / nodes) % cpus.size()]};
+    }
+    case Placement::Numa:
+        return cpus;
+    case Placement::None:
+        break;
+    }
+    return {};
+}
+
+void run_workers(const std::function<void(int worker)>& fn)
+{
+    g_worker_runs.fetch_add(1, std::memory_order_relaxed);
+    const Config& c = config();
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(c.outer));
+    for (int w = 0; w < c.outer; ++w)
+    {
+        threads.emplace_back(
+            [&fn, &c, w]
+            {
+                pin_current_thread(cpus_for(w));
+                if (c.placement == Placement::Numa && !c.topology.simulated)
+                    prefer_node(c.topology.node_ids[node_for(w)]);
+                fn(w);
+            });
+    }
+    for (auto& t : threads)
+        t.join();
+}
+
+uint64_t worker_runs()
+{
+    return g_worker_runs.load(std::memory_order_relaxed);
+}
+
+} // namespace sched
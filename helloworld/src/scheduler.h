@@ -0,0 +1,83 @@
+/**
+ * \file
+ * \ingroup engine
+ * Thread placement for examples that run their own workers on top of OpenCV.
+ *
+ * The runner picks an outer/inner split (`--threads OUTER:INNER`): OUTER is the number of
+ * example worker threads started by run_workers(), INNER is handed to cv::setNumThreads() for
+ * OpenCV's own parallel_for_ pool inside each call (through a hook installed by cv_util.h, so
+ * this file and the runner stay free of OpenCV). A placement pins the outer workers to cores
+ * or NUMA nodes of the detected (or `--topology NxC` simulated) machine; on NUMA placement each
+ * worker also prefers memory from its node, so buffers it allocates are node-local.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sched
+{
+
+struct Topology
+{
+    std::vector<std::vector<int>> nodes; // CPU ids per NUMA node
+    std::vector<int> node_ids;           // kernel node id of each entry in nodes
+    bool simulated = false;
+
+    int cpus() const;
+    std::string describe() const;
+
+    // Nodes and CPUs from /sys (limited to this process' affinity mask)
+    static Topology detect();
+    // `nodes` x `cpus_per_node` laid over the real CPUs (ids wrap around); no memory binding
+    static Topology simulate(int nodes, int cpus_per_node);
+};
+
+enum class Placement
+{
+    None,    // leave scheduling to the OS
+    Compact, // fill node 0 core by core, then node 1, ...
+    Scatter, // round-robin workers over nodes, one core each
+    Numa     // round-robin workers over nodes, free to move within their node
+};
+
+struct Config
+{
+    int outer = 1; // example worker threads
+    int inner = 0; // OpenCV threads per call (0 = leave OpenCV's default)
+    bool explicit_split = false; // set by `--threads`; otherwise examples may pick their own
+    Placement placement = Placement::None;
+    Topology topology; // empty = Topology::detect() on configure()
+};
+
+// Parse helpers for the runner CLI; return false on malformed input
+bool parse_threads(const std::string& s, int& outer, int& inner);
+bool parse_placement(const std::string& s, Placement& out);
+bool parse_topology(const std::string& s, Topology& out);
+const char* to_string(Placement p);
+
+// Make cfg current and pass its inner split to the inner-threads hook, if any
+void configure(const Config& cfg);
+const Config& config();
+
+// Called with Config::inner whenever it is set (and right away if it already is). Returns true
+// so it can initialize a namespace-scope variable.
+using InnerThreadsHook = void (*)(int inner);
+bool set_inner_threads_hook(InnerThreadsHook hook);
+
+// CPUs worker `worker` may run on under the current config (empty = unrestricted)
+std::vector<int> cpus_for(int worker);
+// NUMA node of worker `worker` (-1 when placement is None)
+int node_for(int worker);
+
+// Run fn(worker) on config().outer threads placed per the current config and wait for all.
+// Allocate per-worker buffers inside fn so first touch happens on the worker's node.
+void run_workers(const std::function<void(int worker)>& fn);
+
+// Number of run_workers() calls so far; the runner uses it to tell whether an example honored
+// the outer split
+uint64_t worker_runs();
+
+} // namespace sched
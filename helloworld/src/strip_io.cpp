@@ -0,0 +1,588 @@
+#include "strip_io.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <strings.h>
+#include <unistd.h>
+#include <vector>
+
+#if defined(HELLOWORLD_HAVE_PNG)
+#include <csetjmp>
+#include <png.h>
+#endif
+#if defined(HELLOWORLD_HAVE_TIFF)
+#include <tiffio.h>
+#endif
+
+namespace strip_io
+{
+
+class Reader::Impl
+{
+  public:
+    virtual ~Impl() = default;
+    // Decode image row `row` into dst: info.width pixels of gray or BGR
+    virtual void decode_row(uint8_t* dst) = 0;
+
+    Info info;
+    int row = 0;
+};
+
+class Writer::Impl
+{
+  public:
+    virtual ~Impl() = default;
+    virtual void write_row(const uint8_t* src) = 0;
+    virtual void finish() = 0;
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    int row = 0;
+};
+
+namespace
+{
+
+struct FileCloser
+{
+    void operator()(FILE* f) const
+    {
+        std::fclose(f);
+    }
+};
+using File = std::unique_ptr<FILE, FileCloser>;
+
+std::runtime_error error(const std::string& path, const std::string& what)
+{
+    return std::runtime_error("strip_io: " + path + ": " + what);
+}
+
+// One row of `src_channels` interleaved samples (RGB order when rgb, else BGR) to gray (one or
+// two source channels) or BGR (three or four); alpha is dropped
+void to_gray_or_bgr(const uint8_t* src, int width, int src_channels, bool rgb, uint8_t* dst)
+{
+    if (src_channels < 3)
+    {
+        for (int x = 0; x < width; ++x)
+            dst[x] = src[x * src_channels];
+        return;
+    }
+    for (int x = 0; x < width; ++x, src += src_channels, dst += 3)
+    {
+        dst[0] = rgb ? src[2] : src[0];
+        dst[1] = src[1];
+        dst[2] = rgb ? src[0] : src[2];
+    }
+}
+
+bool pread_full(int fd, uint8_t* buf, size_t n, off_t off)
+{
+    while (n > 0)
+    {
+        const ssize_t got = ::pread(fd, buf, n, off);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return false;
+        buf += got;
+        n -= static_cast<size_t>(got);
+        off += got;
+    }
+    return true;
+}
+
+uint32_t le32(const uint8_t* p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+uint16_t le16(const uint8_t* p)
+{
+    return static_cast<uint16_t>(p[0] | p[1] << 8);
+}
+
+// Binary PGM/PPM (P5/P6), 8 or 16 bits per sample
+class PnmReader final : public Reader::Impl
+{
+  public:
+    PnmReader(const std::string& path, File f) : path_(path), f_(std::move(f))
+    {
+        std::fgetc(f_.get()); // 'P'
+        src_channels_ = std::fgetc(f_.get()) == '5' ? 1 : 3;
+        info.width = next_int();
+        info.height = next_int();
+        maxval_ = next_int();
+        // next_int() consumed the single whitespace byte that separates header and pixels
+        if (info.width <= 0 || info.height <= 0 || maxval_ <= 0 || maxval_ > 65535)
+            throw error(path_, "invalid PNM header");
+        info.channels = src_channels_;
+        info.format = "pnm";
+        raw_.resize(static_cast<size_t>(info.width) * src_channels_ * (maxval_ > 255 ? 2 : 1));
+        row8_.resize(static_cast<size_t>(info.width) * src_channels_);
+    }
+
+    void decode_row(uint8_t* dst) override
+    {
+        if (std::fread(raw_.data(), 1, raw_.size(), f_.get()) != raw_.size())
+            throw error(path_, "truncated PNM data");
+        const uint8_t* src = raw_.data();
+        if (maxval_ != 255)
+        {
+            const bool wide = maxval_ > 255;
+            for (size_t i = 0; i < row8_.size(); ++i)
+            {
+                const unsigned v = wide ? (raw_[2 * i] << 8 | raw_[2 * i + 1]) : raw_[i];
+                row8_[i] = static_cast<uint8_t>(std::min(255U, (v * 255 + maxval_ / 2) / maxval_));
+            }
+            src = row8_.data();
+        }
+        to_gray_or_bgr(src, info.width, src_channels_, true, dst);
+    }
+
+  private:
+    // Decimal header field; skips whitespace and # comments, consumes one trailing byte
+    int next_int()
+    {
+        int c = std::fgetc(f_.get());
+        while (c == '#' || std::isspace(c))
+        {
+            if (c == '#')
+                while (c != '\n' && c != EOF)
+                    c = std::fgetc(f_.get());
+            c = std::fgetc(f_.get());
+        }
+        long v = -1;
+        for (; c >= '0' && c <= '9' && v < (1L << 24); c = std::fgetc(f_.get()))
+            v = (v < 0 ? 0 : v * 10) + (c - '0');
+        return static_cast<int>(v);
+    }
+
+    std::string path_;
+    File f_;
+    int src_channels_ = 1;
+    int maxval_ = 255;
+    std::vector<uint8_t> raw_;
+    std::vector<uint8_t> row8_;
+};
+
+// Uncompressed 24/32-bit BMP; bottom-up files are read backwards with pread
+class BmpReader final : public Reader::Impl
+{
+  public:
+    BmpReader(const std::string& path, File f) : path_(path), f_(std::move(f))
+    {
+        uint8_t h[54];
+        if (!pread_full(fd(), h, sizeof(h), 0) || le32(h + 14) < 40)
+            throw error(path_, "invalid BMP header");
+        offset_ = le32(h + 10);
+        const auto width = static_cast<int32_t>(le32(h + 18));
+        const auto height = static_cast<int32_t>(le32(h + 22));
+        bpp_ = le16(h + 28);
+        const uint32_t compression = le32(h + 30);
+        // BI_RGB, or BI_BITFIELDS with the usual BGRA masks for 32 bpp
+        if ((bpp_ != 24 && bpp_ != 32) || !(compression == 0 || (compression == 3 && bpp_ == 32)))
+            throw error(path_, "only uncompressed 24/32-bit BMP can be streamed");
+        if (width <= 0 || height == 0 || height == INT32_MIN)
+            throw error(path_, "invalid BMP size");
+        top_down_ = height < 0;
+        info.width = width;
+        info.height = std::abs(height);
+        info.channels = 3;
+        info.format = "bmp";
+        raw_.resize((static_cast<size_t>(width) * bpp_ + 31) / 32 * 4);
+    }
+
+    void decode_row(uint8_t* dst) override
+    {
+        const int file_row = top_down_ ? row : info.height - 1 - row;
+        const off_t off = static_cast<off_t>(offset_) + static_cast<off_t>(file_row) * raw_.size();
+        if (!pread_full(fd(), raw_.data(), raw_.size(), off))
+            throw error(path_, "truncated BMP data");
+        to_gray_or_bgr(raw_.data(), info.width, bpp_ / 8, false, dst);
+    }
+
+  private:
+    int fd() const
+    {
+        return ::fileno(f_.get());
+    }
+
+    std::string path_;
+    File f_;
+    uint32_t offset_ = 0;
+    int bpp_ = 24;
+    bool top_down_ = false;
+    std::vector<uint8_t> raw_;
+};
+
+#if defined(HELLOWORLD_HAVE_PNG)
+// libpng reports errors by longjmp to the setjmp in the calling frame: the functions that call
+// into it keep C++ objects with destructors out of those frames and return false instead
+class PngReader final : public Reader::Impl
+{
+  public:
+    PngReader(const std::string& path, File f) : path_(path), f_(std::move(f))
+    {
+        png_ = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        info_ = png_ ? png_create_info_struct(png_) : nullptr;
+        if (!info_)
+        {
+            png_destroy_read_struct(&png_, nullptr, nullptr);
+            throw error(path_, "out of memory");
+        }
+        if (!read_header())
+        {
+            png_destroy_read_struct(&png_, &info_, nullptr);
+            throw error(path_, "invalid PNG header");
+        }
+        if (interlaced_)
+        {
+            png_destroy_read_struct(&png_, &info_, nullptr);
+            throw error(path_, "interlaced PNG cannot be streamed (re-encode without Adam7)");
+        }
+        info.format = "png";
+    }
+
+    ~PngReader() override
+    {
+        png_destroy_read_struct(&png_, &info_, nullptr);
+    }
+
+    void decode_row(uint8_t* dst) override
+    {
+        if (!read_row(dst))
+            throw error(path_, "corrupt PNG data");
+    }
+
+  private:
+    bool read_header()
+    {
+        if (setjmp(png_jmpbuf(png_)))
+            return false;
+        png_init_io(png_, f_.get());
+        png_read_info(png_, info_);
+        png_uint_32 w = 0;
+        png_uint_32 h = 0;
+        int depth = 0;
+        int color = 0;
+        int interlace = 0;
+        png_get_IHDR(png_, info_, &w, &h, &depth, &color, &interlace, nullptr, nullptr);
+        interlaced_ = interlace != PNG_INTERLACE_NONE;
+        if (depth == 16)
+            png_set_strip_16(png_);
+        if (color == PNG_COLOR_TYPE_PALETTE)
+            png_set_palette_to_rgb(png_);
+        if (color == PNG_COLOR_TYPE_GRAY && depth < 8)
+            png_set_expand_gray_1_2_4_to_8(png_);
+        if (color & PNG_COLOR_MASK_ALPHA)
+            png_set_strip_alpha(png_);
+        png_set_bgr(png_);
+        png_read_update_info(png_, info_);
+        info.width = static_cast<int>(w);
+        info.height = static_cast<int>(h);
+        info.channels = png_get_channels(png_, info_);
+        return info.channels == 1 || info.channels == 3;
+    }
+
+    bool read_row(uint8_t* dst)
+    {
+        if (setjmp(png_jmpbuf(png_)))
+            return false;
+        png_read_row(png_, dst, nullptr);
+        return true;
+    }
+
+    std::string path_;
+    File f_;
+    png_structp png_ = nullptr;
+    png_infop info_ = nullptr;
+    bool interlaced_ = false;
+};
+
+class PngWriter final : public Writer::Impl
+{
+  public:
+    PngWriter(const std::string& path, File f, int w, int h, int c) : path_(path), f_(std::move(f))
+    {
+        width = w;
+        height = h;
+        channels = c;
+        png_ = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+        info_ = png_ ? png_create_info_struct(png_) : nullptr;
+        if (!info_ || !write_header())
+        {
+            png_destroy_write_struct(&png_, &info_);
+            throw error(path_, "cannot start PNG");
+        }
+    }
+
+    ~PngWriter() override
+    {
+        png_destroy_write_struct(&png_, &info_);
+    }
+
+    void write_row(const uint8_t* src) override
+    {
+        if (!put_row(src))
+            throw error(path_, "PNG write failed");
+    }
+
+    void finish() override
+    {
+        if (!end() || std::fflush(f_.get()) != 0)
+            throw error(path_, "PNG write failed");
+    }
+
+  private:
+    bool write_header()
+    {
+        if (setjmp(png_jmpbuf(png_)))
+            return false;
+        png_init_io(png_, f_.get());
+        png_set_IHDR(png_, info_, static_cast<png_uint_32>(width), static_cast<png_uint_32>(height),
+                     8, channels == 1 ? PNG_COLOR_TYPE_GRAY : PNG_COLOR_TYPE_RGB,
+                     PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+        png_write_info(png_, info_);
+        png_set_bgr(png_);
+        return true;
+    }
+
+    bool put_row(const uint8_t* src)
+    {
+        if (setjmp(png_jmpbuf(png_)))
+            return false;
+        png_write_row(png_, src);
+        return true;
+    }
+
+    bool end()
+    {
+        if (setjmp(png_jmpbuf(png_)))
+            return false;
+        png_write_end(png_, nullptr);
+        return true;
+    }
+
+    std::string path_;
+    File f_;
+    png_structp png_ = nullptr;
+    png_infop info_ = nullptr;
+};
+#endif
+
+#if defined(HELLOWORLD_HAVE_TIFF)
+// Strip-organized (not tiled) 8-bit TIFF, read scanline by scanline
+class TiffReader final : public Reader::Impl
+{
+  public:
+    explicit TiffReader(const std::string& path) : path_(path)
+    {
+        tif_ = TIFFOpen(path.c_str(), "r");
+        if (!tif_)
+            throw error(path_, "cannot open TIFF");
+        uint32_t w = 0;
+        uint32_t h = 0;
+        uint16_t bps = 8;
+        uint16_t planar = PLANARCONFIG_CONTIG;
+        uint16_t photometric = PHOTOMETRIC_MINISBLACK;
+        TIFFGetField(tif_, TIFFTAG_IMAGEWIDTH, &w);
+        TIFFGetField(tif_, TIFFTAG_IMAGELENGTH, &h);
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_SAMPLESPERPIXEL, &spp_);
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_BITSPERSAMPLE, &bps);
+        TIFFGetFieldDefaulted(tif_, TIFFTAG_PLANARCONFIG, &planar);
+        TIFFGetField(tif_, TIFFTAG_PHOTOMETRIC, &photometric);
+        const bool gray = photometric == PHOTOMETRIC_MINISBLACK ||
+                          photometric == PHOTOMETRIC_MINISWHITE;
+        if (TIFFIsTiled(tif_) || bps != 8 || planar != PLANARCONFIG_CONTIG || w == 0 || h == 0 ||
+            spp_ < 1 || spp_ > 4 || !(gray || photometric == PHOTOMETRIC_RGB))
+        {
+            TIFFClose(tif_);
+            throw error(path_, "only strip-organized 8-bit gray/RGB TIFF can be streamed");
+        }
+        invert_ = photometric == PHOTOMETRIC_MINISWHITE;
+        info.width = static_cast<int>(w);
+        info.height = static_cast<int>(h);
+        info.channels = spp_ >= 3 ? 3 : 1;
+        info.format = "tiff";
+        raw_.resize(static_cast<size_t>(TIFFScanlineSize(tif_)));
+    }
+
+    ~TiffReader() override
+    {
+        TIFFClose(tif_);
+    }
+
+    void decode_row(uint8_t* dst) override
+    {
+        if (TIFFReadScanline(tif_, raw_.data(), static_cast<uint32_t>(row), 0) < 0)
+            throw error(path_, "corrupt TIFF data");
+        if (invert_)
+            for (auto& v : raw_)
+                v = static_cast<uint8_t>(255 - v);
+        to_gray_or_bgr(raw_.data(), info.width, spp_, true, dst);
+    }
+
+  private:
+    std::string path_;
+    TIFF* tif_ = nullptr;
+    uint16_t spp_ = 1;
+    bool invert_ = false;
+    std::vector<uint8_t> raw_;
+};
+#endif
+
+class PnmWriter final : public Writer::Impl
+{
+  public:
+    PnmWriter(const std::string& path, File f, int w, int h, int c) : path_(path), f_(std::move(f))
+    {
+        width = w;
+        height = h;
+        channels = c;
+        if (std::fprintf(f_.get(), "P%c\n%d %d\n255\n", c == 1 ? '5' : '6', w, h) < 0)
+            throw error(path_, "write failed");
+        rgb_.resize(static_cast<size_t>(w) * c);
+    }
+
+    void write_row(const uint8_t* src) override
+    {
+        if (channels == 3)
+        {
+            to_gray_or_bgr(src, width, 3, true, rgb_.data()); // BGR -> RGB is the same swap
+            src = rgb_.data();
+        }
+        if (std::fwrite(src, 1, rgb_.size(), f_.get()) != rgb_.size())
+            throw error(path_, "write failed");
+    }
+
+    void finish() override
+    {
+        if (std::fflush(f_.get()) != 0)
+            throw error(path_, "write failed");
+    }
+
+  private:
+    std::string path_;
+    File f_;
+    std::vector<uint8_t> rgb_;
+};
+
+bool has_extension(const std::string& path, const char* ext)
+{
+    const size_t n = std::strlen(ext);
+    return path.size() >= n && strcasecmp(path.c_str() + path.size() - n, ext) == 0;
+}
+
+} // namespace
+
+Reader::Reader(const std::string& path)
+{
+    File f(std::fopen(path.c_str(), "rb"));
+    if (!f)
+        throw error(path, std::strerror(errno));
+    uint8_t magic[8] = {};
+    const size_t n = std::fread(magic, 1, sizeof(magic), f.get());
+    std::rewind(f.get());
+
+    if (n >= 2 && magic[0] == 'P' && (magic[1] == '5' || magic[1] == '6'))
+        impl_ = std::make_unique<PnmReader>(path, std::move(f));
+    else if (n >= 2 && magic[0] == 'B' && magic[1] == 'M')
+        impl_ = std::make_unique<BmpReader>(path, std::move(f));
+    else if (n == 8 && std::memcmp(magic, "\x89PNG\r\n\x1a\n", 8) == 0)
+    {
+#if defined(HELLOWORLD_HAVE_PNG)
+        impl_ = std::make_unique<PngReader>(path, std::move(f));
+#else
+        throw error(path, "PNG streaming needs a build with libpng");
+#endif
+    }
+    else if (n >= 4 && (std::memcmp(magic, "II*\0", 4) == 0 || std::memcmp(magic, "MM\0*", 4) == 0))
+    {
+#if defined(HELLOWORLD_HAVE_TIFF)
+        f.reset();
+        impl_ = std::make_unique<TiffReader>(path);
+#else
+        throw error(path, "TIFF streaming needs a build with libtiff");
+#endif
+    }
+    else
+        throw error(path, "unsupported format for streaming (PNM, BMP, PNG, TIFF)");
+}
+
+Reader::~Reader() = default;
+
+const Info& Reader::info() const
+{
+    return impl_->info;
+}
+
+int Reader::row() const
+{
+    return impl_->row;
+}
+
+int Reader::read(cv::Mat rows)
+{
+    const Info& in = impl_->info;
+    if (rows.cols != in.width || rows.type() != CV_8UC(in.channels))
+        throw std::runtime_error("strip_io: row buffer does not match the image");
+    const int n = std::min(rows.rows, in.height - impl_->row);
+    for (int r = 0; r < n; ++r, ++impl_->row)
+        impl_->decode_row(rows.ptr(r));
+    return n;
+}
+
+Writer::Writer(const std::string& path, int width, int height, int channels)
+{
+    if (width <= 0 || height <= 0 || (channels != 1 && channels != 3))
+        throw error(path, "invalid output size");
+    File f(std::fopen(path.c_str(), "wb"));
+    if (!f)
+        throw error(path, std::strerror(errno));
+#if defined(HELLOWORLD_HAVE_PNG)
+    if (has_extension(path, ".png"))
+    {
+        impl_ = std::make_unique<PngWriter>(path, std::move(f), width, height, channels);
+        return;
+    }
+#endif
+    if (!has_extension(path, ".pgm") && !has_extension(path, ".ppm") &&
+        !has_extension(path, ".pnm"))
+        throw error(path, std::string("unsupported output format (use ") + gray_extension() + ")");
+    impl_ = std::make_unique<PnmWriter>(path, std::move(f), width, height, channels);
+}
+
+Writer::~Writer() = default;
+
+void Writer::write(const cv::Mat& rows)
+{
+    if (rows.cols != impl_->width || rows.type() != CV_8UC(impl_->channels) ||
+        impl_->row + rows.rows > impl_->height)
+        throw std::runtime_error("strip_io: rows do not match the output image");
+    for (int r = 0; r < rows.rows; ++r, ++impl_->row)
+        impl_->write_row(rows.ptr(r));
+}
+
+void Writer::finish()
+{
+    if (impl_->row != impl_->height)
+        throw std::runtime_error("strip_io: output incomplete");
+    impl_->finish();
+}
+
+const char* gray_extension()
+{
+#if defined(HELLOWORLD_HAVE_PNG)
+    return ".png";
+#else
+    return ".pgm";
+#endif
+}
+
+} // namespace strip_io
@@ -0,0 +1,82 @@
+/**
+ * \file
+ * Strip-streamed image decode and encode for images too large to hold in memory.
+ *
+ * A Reader decodes an image top to bottom a few rows at a time into caller-provided rows, so
+ * memory use depends on the image width and the strip height only. Binary PNM (P5/P6) and
+ * uncompressed BMP are always supported; non-interlaced PNG and strip-organized TIFF need the
+ * build to find libpng / libtiff. A Writer appends rows to a PNM (or, with libpng, PNG) file.
+ * Pixels are 8-bit gray or BGR, like cv::imread; alpha is dropped and 16-bit samples are scaled
+ * down to 8 bits.
+ */
+#pragma once
+
+#include <memory>
+#include <opencv2/core.hpp>
+#include <string>
+
+namespace strip_io
+{
+
+struct Info
+{
+    int width = 0;
+    int height = 0;
+    int channels = 0; // 1 (gray) or 3 (BGR)
+    const char* format = "";
+};
+
+class Reader
+{
+  public:
+    // Open path and read its header; the format is detected from the file's magic bytes.
+    // Throws std::runtime_error if the file is unreadable or cannot be streamed.
+    explicit Reader(const std::string& path);
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    const Info& info() const;
+
+    // Decode the next rows into `rows` (info().width wide, CV_8UC(info().channels), e.g. a
+    // rowRange of a larger buffer). Returns the rows decoded: fewer than rows.rows only at the
+    // end of the image. Throws std::runtime_error on corrupt or truncated data.
+    int read(cv::Mat rows);
+
+    // Next image row to be decoded
+    int row() const;
+
+    class Impl;
+
+  private:
+    std::unique_ptr<Impl> impl_;
+};
+
+class Writer
+{
+  public:
+    // Create path for a width x height image with 1 or 3 channels: `.png` (with libpng),
+    // otherwise PGM/PPM. Throws std::runtime_error on failure.
+    Writer(const std::string& path, int width, int height, int channels);
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // Append rows (top to bottom) of the declared width and channels
+    void write(const cv::Mat& rows);
+
+    // Flush and close; throws if not all rows were written or the file could not be written
+    void finish();
+
+    class Impl;
+
+  private:
+    std::unique_ptr<Impl> impl_;
+};
+
+// Output extension Writer supports best: ".png" when built with libpng, else ".pgm"
+const char* gray_extension();
+
+} // namespace strip_io